@@ -0,0 +1,239 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <new>
+#include "allocations.h"
+
+namespace {
+    const int REPORTED_ALLOCATIONS = 8;
+
+    // Every block is preceded by its size and tag so operator delete can charge the free to the tag
+    // that paid for the allocation, and by its distance from the start of the malloc'd memory, which
+    // grows when the block needs more than malloc's alignment.
+    struct BlockHeader {
+        std::size_t size;
+        std::uint32_t tag;
+        std::uint32_t offset;
+    };
+    const std::size_t HEADER_SIZE = 16;
+    static_assert(sizeof(BlockHeader) <= HEADER_SIZE, "block header must fit before the block");
+
+    struct TagTotals {
+        std::atomic<std::int64_t> current;
+        std::atomic<std::int64_t> peak;
+        std::atomic<std::uint64_t> allocations;
+    };
+
+    // Zero initialized before any constructor runs, so allocations made during static initialization count.
+    TagTotals tags[MemoryTags::COUNT];
+
+    thread_local std::uint64_t allocation_count = 0;
+    thread_local std::uint64_t allocation_bytes = 0;
+    thread_local const char* watch_label = nullptr;
+    thread_local std::uint64_t watch_start = 0;
+
+    void charge(int tag, std::int64_t bytes) {
+        TagTotals& totals = tags[tag];
+        std::int64_t current = totals.current.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+        std::int64_t peak = totals.peak.load(std::memory_order_relaxed);
+        while (current > peak && !totals.peak.compare_exchange_weak(peak, current, std::memory_order_relaxed)) {}
+    }
+
+    void* allocate(std::size_t size, std::size_t alignment = HEADER_SIZE) {
+        allocation_count += 1;
+        allocation_bytes += size;
+#ifdef GRAVITYARENA_ARENA_DEBUG
+        if (watch_label && allocation_count - watch_start <= REPORTED_ALLOCATIONS) {
+            std::fprintf(stderr, "heap allocation of %zu bytes inside %s\n", size, watch_label);
+        }
+#endif
+        alignment = std::max(alignment, HEADER_SIZE);
+        std::size_t padding = alignment - HEADER_SIZE;
+        char* block = (char*) std::malloc(HEADER_SIZE + padding + size);
+        if (!block) {
+            return nullptr;
+        }
+        std::size_t start = (std::size_t) block + HEADER_SIZE;
+        char* pointer = block + HEADER_SIZE + (alignment - start % alignment) % alignment;
+        BlockHeader* header = (BlockHeader*) pointer - 1;
+        header->size = size;
+        header->tag = (std::uint32_t) Allocations::current_tag();
+        header->offset = (std::uint32_t) (pointer - block);
+        tags[header->tag].allocations.fetch_add(1, std::memory_order_relaxed);
+        charge(header->tag, (std::int64_t) size);
+        return pointer;
+    }
+
+    void release(void* pointer) {
+        if (!pointer) {
+            return;
+        }
+        const BlockHeader* header = (const BlockHeader*) pointer - 1;
+        tags[header->tag].current.fetch_sub((std::int64_t) header->size, std::memory_order_relaxed);
+        std::free((char*) pointer - header->offset);
+    }
+}
+
+std::uint64_t Allocations::count() {
+    return allocation_count;
+}
+
+std::uint64_t Allocations::bytes() {
+    return allocation_bytes;
+}
+
+void Allocations::begin_watch(const char* label) {
+    watch_label = label;
+    watch_start = allocation_count;
+}
+
+std::uint64_t Allocations::end_watch() {
+    std::uint64_t watched = allocation_count - watch_start;
+#ifdef GRAVITYARENA_ARENA_DEBUG
+    if (watched > REPORTED_ALLOCATIONS) {
+        std::fprintf(stderr, "%llu heap allocations inside %s\n", (unsigned long long) watched, watch_label);
+    }
+#endif
+    watch_label = nullptr;
+    return watched;
+}
+
+MemoryUsage Allocations::usage(int tag) {
+    MemoryUsage usage;
+    usage.current = tags[tag].current.load(std::memory_order_relaxed);
+    usage.peak = tags[tag].peak.load(std::memory_order_relaxed);
+    usage.allocations = tags[tag].allocations.load(std::memory_order_relaxed);
+    return usage;
+}
+
+std::int64_t Allocations::total() {
+    std::int64_t total = 0;
+    for (int tag = 0; tag < MemoryTags::COUNT; tag++) {
+        total += tags[tag].current.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+void Allocations::reset_peaks() {
+    for (int tag = 0; tag < MemoryTags::COUNT; tag++) {
+        tags[tag].peak.store(tags[tag].current.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+}
+
+void Allocations::add_external(int tag, std::int64_t bytes) {
+    if (bytes > 0) {
+        tags[tag].allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+    charge(tag, bytes);
+}
+
+void Allocations::report(std::ostream& stream) {
+    std::ios::fmtflags flags = stream.flags();
+    stream << "memory:" << std::fixed << std::setprecision(1) << std::endl;
+    for (int tag = 0; tag < MemoryTags::COUNT; tag++) {
+        MemoryUsage tag_usage = usage(tag);
+        stream << "  " << std::setw(10) << std::left << tag_name(tag) << std::right
+               << " current " << std::setw(9) << tag_usage.current / 1024.0 << " kB"
+               << " peak " << std::setw(9) << tag_usage.peak / 1024.0 << " kB"
+               << " allocations " << tag_usage.allocations << std::endl;
+    }
+    stream << "  total      current " << std::setw(9) << total() / 1024.0 << " kB" << std::endl;
+    stream.flags(flags);
+}
+
+void* operator new(std::size_t size) {
+    void* pointer = allocate(size);
+    if (!pointer) {
+        throw std::bad_alloc();
+    }
+    return pointer;
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+// Every replaceable form the language level offers is defined, so no block reaches a default operator
+// delete that would not know about the header. Sized deallocation arrives with C++14 and aligned
+// allocation with C++17.
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return allocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return allocate(size);
+}
+
+void operator delete(void* pointer) noexcept {
+    release(pointer);
+}
+
+void operator delete[](void* pointer) noexcept {
+    release(pointer);
+}
+
+void operator delete(void* pointer, const std::nothrow_t&) noexcept {
+    release(pointer);
+}
+
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept {
+    release(pointer);
+}
+
+#ifdef __cpp_sized_deallocation
+void operator delete(void* pointer, std::size_t) noexcept {
+    release(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t) noexcept {
+    release(pointer);
+}
+#endif
+
+#ifdef __cpp_aligned_new
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    void* pointer = allocate(size, (std::size_t) alignment);
+    if (!pointer) {
+        throw std::bad_alloc();
+    }
+    return pointer;
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return operator new(size, alignment);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return allocate(size, (std::size_t) alignment);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return allocate(size, (std::size_t) alignment);
+}
+
+void operator delete(void* pointer, std::align_val_t) noexcept {
+    release(pointer);
+}
+
+void operator delete[](void* pointer, std::align_val_t) noexcept {
+    release(pointer);
+}
+
+void operator delete(void* pointer, std::size_t, std::align_val_t) noexcept {
+    release(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t, std::align_val_t) noexcept {
+    release(pointer);
+}
+
+void operator delete(void* pointer, std::align_val_t, const std::nothrow_t&) noexcept {
+    release(pointer);
+}
+
+void operator delete[](void* pointer, std::align_val_t, const std::nothrow_t&) noexcept {
+    release(pointer);
+}
+#endif
@@ -0,0 +1,77 @@
+#ifndef GRAVITYARENA_ALLOCATIONS_H
+#define GRAVITYARENA_ALLOCATIONS_H
+
+#include <cstdint>
+#include <ostream>
+
+namespace MemoryTags {
+    enum Enum {
+        OTHER,
+        ASSETS,
+        TEXTURES,
+        BULLETS,
+        TRAILS,
+        PHYSICS,
+        PARTICLES,
+        HUD,
+        AUDIO,
+        NETWORK,
+        COUNT
+    };
+}
+
+struct MemoryUsage {
+    std::int64_t current;
+    std::int64_t peak;
+    std::uint64_t allocations;
+};
+
+// Counts heap allocations made through the global operator new on the calling thread, and accounts
+// every allocation to the memory tag that was current when it was made.
+// Only available in targets that link allocations.cpp, which replaces operator new and delete; the
+// tag scopes below are header-only so tagged code also builds in targets that do not track memory.
+namespace Allocations {
+    std::uint64_t count();
+    std::uint64_t bytes();
+
+    // With GRAVITYARENA_ARENA_DEBUG, heap allocations on this thread between begin_watch() and end_watch()
+    // are reported on stderr. end_watch() returns how many there were.
+    void begin_watch(const char* label);
+    std::uint64_t end_watch();
+
+    MemoryUsage usage(int tag);
+    std::int64_t total();
+    void reset_peaks();
+    // For memory the allocator never sees, such as textures held by the graphics driver.
+    void add_external(int tag, std::int64_t bytes);
+    void report(std::ostream& stream);
+
+    inline int& current_tag() {
+        static thread_local int tag = MemoryTags::OTHER;
+        return tag;
+    }
+
+    inline const char* tag_name(int tag) {
+        static const char* NAMES[] = {"other", "assets", "textures", "bullets", "trails", "physics", "particles",
+                                      "hud", "audio", "network"};
+        return NAMES[tag];
+    }
+}
+
+// Allocations on this thread are tagged with tag until the scope ends. Scopes nest.
+class MemoryScope {
+public:
+    MemoryScope(int tag) :
+            previous(Allocations::current_tag())
+    {
+        Allocations::current_tag() = tag;
+    }
+
+    ~MemoryScope() {
+        Allocations::current_tag() = previous;
+    }
+private:
+    int previous;
+};
+
+#endif //GRAVITYARENA_ALLOCATIONS_H
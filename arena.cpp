@@ -0,0 +1,49 @@
+#include <algorithm>
+#include <cstring>
+#include "arena.h"
+#include "allocations.h"
+
+FrameArena::FrameArena(std::size_t capacity) {
+    MemoryScope scope(MemoryTags::PHYSICS);
+    buffer.resize(capacity);
+}
+
+void* FrameArena::allocate(std::size_t bytes, std::size_t alignment) {
+    std::size_t start = (offset + alignment - 1) & ~(alignment - 1);
+    if (start + bytes <= buffer.size()) {
+        offset = start + bytes;
+        return buffer.data() + start;
+    }
+    MemoryScope scope(MemoryTags::PHYSICS);
+    overflow.push_back(std::vector<char>(bytes + alignment));
+    overflow_bytes += bytes + alignment;
+    overflow_count += 1;
+    char* block = overflow.back().data();
+    std::size_t padding = (alignment - (std::size_t) block % alignment) % alignment;
+    return block + padding;
+}
+
+void FrameArena::reset() {
+    if (!overflow.empty()) {
+        MemoryScope scope(MemoryTags::PHYSICS);
+        buffer.resize(std::max(buffer.size(), offset + overflow_bytes));
+        overflow.clear();
+        overflow_bytes = 0;
+    }
+#ifdef GRAVITYARENA_ARENA_DEBUG
+    std::memset(buffer.data(), 0xcd, offset);
+#endif
+    offset = 0;
+}
+
+std::size_t FrameArena::get_used() const {
+    return offset + overflow_bytes;
+}
+
+std::size_t FrameArena::get_capacity() const {
+    return buffer.size();
+}
+
+int FrameArena::get_overflow_count() const {
+    return overflow_count;
+}
@@ -0,0 +1,62 @@
+#ifndef GRAVITYARENA_ARENA_H
+#define GRAVITYARENA_ARENA_H
+
+#include <cstddef>
+#include <vector>
+
+// Bump allocator for data that only lives for one tick. Memory is released all at once by reset(); if a
+// tick needs more than the buffer holds, the extra comes from overflow blocks and the buffer grows to fit
+// on the next reset.
+class FrameArena {
+public:
+    FrameArena(std::size_t capacity);
+    void* allocate(std::size_t bytes, std::size_t alignment);
+    void reset();
+    std::size_t get_used() const;
+    std::size_t get_capacity() const;
+    int get_overflow_count() const;
+private:
+    std::vector<char> buffer;
+    std::size_t offset = 0;
+    std::vector<std::vector<char>> overflow;
+    std::size_t overflow_bytes = 0;
+    int overflow_count = 0;
+};
+
+template <typename T>
+class ArenaAllocator {
+public:
+    typedef T value_type;
+
+    ArenaAllocator(FrameArena& arena) :
+            arena(&arena)
+    {}
+
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) :
+            arena(other.arena)
+    {}
+
+    T* allocate(std::size_t count) {
+        return static_cast<T*>(arena->allocate(count * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T*, std::size_t) {}
+
+    template <typename U>
+    bool operator ==(const ArenaAllocator<U>& other) const {
+        return arena == other.arena;
+    }
+
+    template <typename U>
+    bool operator !=(const ArenaAllocator<U>& other) const {
+        return arena != other.arena;
+    }
+
+    FrameArena* arena;
+};
+
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+#endif //GRAVITYARENA_ARENA_H
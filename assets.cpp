@@ -0,0 +1,132 @@
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include "assets.h"
+#include "allocations.h"
+
+AssetManager::AssetManager(unsigned thread_count) :
+        thread_count(thread_count ? thread_count : std::max(1u, std::thread::hardware_concurrency())),
+        next_asset(0)
+{}
+
+AssetManager::~AssetManager() {
+    wait();
+}
+
+void AssetManager::add(std::string name, int type) {
+    Asset asset;
+    asset.name = name;
+    asset.type = type;
+    assets.push_back(asset);
+}
+
+void AssetManager::start() {
+    // Workers index into assets, so nothing may be added until wait() returns.
+    next_asset = 0;
+    load_clock.restart();
+    unsigned count = std::min(thread_count, (unsigned) assets.size());
+    for (unsigned i = 0; i < count; i++) {
+        workers.push_back(std::thread(&AssetManager::work, this));
+    }
+}
+
+void AssetManager::wait() {
+    if (workers.empty()) {
+        return;
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    workers.clear();
+    load_time = load_clock.getElapsedTime();
+}
+
+bool AssetManager::is_loaded(std::string name) const {
+    return find(name).loaded;
+}
+
+const sf::Image& AssetManager::get_image(std::string name) const {
+    return find(name).image;
+}
+
+const sf::SoundBuffer& AssetManager::get_sound(std::string name) const {
+    return find(name).sound;
+}
+
+const std::string& AssetManager::get_data(std::string name) const {
+    return find(name).data;
+}
+
+bool AssetManager::upload(std::string name, sf::Texture& texture) {
+    Asset& asset = find(name);
+    sf::Clock clock;
+    bool uploaded = asset.loaded && texture.loadFromImage(asset.image);
+    asset.upload_time = clock.getElapsedTime();
+    return uploaded;
+}
+
+void AssetManager::report(std::ostream& stream) const {
+    sf::Time decode_total;
+    sf::Time upload_total;
+    stream << std::fixed << std::setprecision(2);
+    for (const Asset& asset : assets) {
+        stream << std::setw(20) << std::left << asset.name
+               << " decode " << std::setw(8) << std::right << asset.decode_time.asMicroseconds() / 1000.f << " ms"
+               << " upload " << std::setw(8) << asset.upload_time.asMicroseconds() / 1000.f << " ms"
+               << (asset.loaded ? "" : " FAILED") << std::endl;
+        decode_total += asset.decode_time;
+        upload_total += asset.upload_time;
+    }
+    stream << "assets: " << assets.size() << " on " << std::min(thread_count, (unsigned) assets.size()) << " threads"
+           << ", decode " << decode_total.asMicroseconds() / 1000.f << " ms cpu / "
+           << load_time.asMicroseconds() / 1000.f << " ms wall"
+           << ", upload " << upload_total.asMicroseconds() / 1000.f << " ms" << std::endl;
+}
+
+void AssetManager::work() {
+    for (size_t i = next_asset++; i < assets.size(); i = next_asset++) {
+        decode(assets[i]);
+    }
+}
+
+void AssetManager::decode(Asset& asset) {
+    MemoryScope scope(MemoryTags::ASSETS);
+    sf::Clock clock;
+    switch (asset.type) {
+        case AssetTypes::IMAGE:
+            asset.loaded = asset.image.loadFromFile(asset.name);
+            break;
+        case AssetTypes::SOUND:
+            asset.loaded = asset.sound.loadFromFile(asset.name);
+            break;
+        case AssetTypes::DATA: {
+            std::ifstream file(asset.name, std::ios::binary);
+            std::stringstream data;
+            data << file.rdbuf();
+            asset.data = data.str();
+            asset.loaded = file.is_open();
+            break;
+        }
+    }
+    asset.decode_time = clock.getElapsedTime();
+}
+
+AssetManager::Asset& AssetManager::find(std::string name) {
+    for (Asset& asset : assets) {
+        if (asset.name == name) {
+            return asset;
+        }
+    }
+    throw std::out_of_range("unknown asset " + name);
+}
+
+const AssetManager::Asset& AssetManager::find(std::string name) const {
+    for (const Asset& asset : assets) {
+        if (asset.name == name) {
+            return asset;
+        }
+    }
+    throw std::out_of_range("unknown asset " + name);
+}
@@ -0,0 +1,55 @@
+#ifndef GRAVITYARENA_ASSETS_H
+#define GRAVITYARENA_ASSETS_H
+
+#include <SFML/Graphics.hpp>
+#include <SFML/Audio.hpp>
+#include <atomic>
+#include <thread>
+
+namespace AssetTypes {
+    enum Enum {
+        IMAGE,
+        SOUND,
+        DATA
+    };
+}
+
+class AssetManager {
+public:
+    AssetManager(unsigned thread_count = 0);
+    ~AssetManager();
+    void add(std::string name, int type = AssetTypes::IMAGE);
+    void start();
+    void wait();
+    bool is_loaded(std::string name) const;
+    const sf::Image& get_image(std::string name) const;
+    const sf::SoundBuffer& get_sound(std::string name) const;
+    const std::string& get_data(std::string name) const;
+    bool upload(std::string name, sf::Texture& texture);
+    void report(std::ostream& stream) const;
+private:
+    struct Asset {
+        std::string name;
+        int type;
+        sf::Image image;
+        sf::SoundBuffer sound;
+        std::string data;
+        bool loaded = false;
+        sf::Time decode_time;
+        sf::Time upload_time;
+    };
+
+    unsigned thread_count;
+    std::vector<Asset> assets;
+    std::vector<std::thread> workers;
+    std::atomic<size_t> next_asset;
+    sf::Clock load_clock;
+    sf::Time load_time;
+
+    void work();
+    void decode(Asset& asset);
+    Asset& find(std::string name);
+    const Asset& find(std::string name) const;
+};
+
+#endif //GRAVITYARENA_ASSETS_H
@@ -0,0 +1,211 @@
+#include <cmath>
+#include <fstream>
+#include "audio.h"
+#include "allocations.h"
+#include "game.h"
+
+namespace {
+    struct SoundDefinition {
+        int priority;
+        int max_voices;
+        float volume;
+        float duration;
+    };
+
+    const SoundDefinition SOUNDS[Sounds::COUNT] = {
+            {0, 4, 35, 0.08f},
+            {1, 3, 50, 0.06f},
+            {2, 2, 70, 0.15f},
+            {3, 2, 100, 0.7f}
+    };
+
+    const float PITCH_VARIATION = 0.05f;
+
+    // The effects are synthesized at startup instead of shipped as files.
+    std::vector<sf::Int16> synthesize(int sound, unsigned sample_rate) {
+        std::minstd_rand random((unsigned) sound + 1);
+        std::uniform_real_distribution<float> noise(-1, 1);
+        int count = (int) (SOUNDS[sound].duration * sample_rate);
+        std::vector<sf::Int16> samples(count);
+        float phase = 0;
+        float filtered = 0;
+        for (int i = 0; i < count; i++) {
+            float progress = (float) i / count;
+            float envelope = (1 - progress) * (1 - progress);
+            float value = 0;
+            switch (sound) {
+                case Sounds::SHOOT:
+                    phase += 1400 * std::pow(0.35f, progress) / sample_rate;
+                    value = phase - std::floor(phase) < 0.5f ? 1 : -1;
+                    break;
+                case Sounds::IMPACT:
+                    value = noise(random) * (1 - progress);
+                    break;
+                case Sounds::HURT:
+                    phase += (220 - 110 * progress) / sample_rate;
+                    value = std::sin(2 * PI * phase) + 0.2f * noise(random);
+                    envelope = 1 - progress;
+                    break;
+                case Sounds::EXPLOSION:
+                    filtered += (noise(random) - filtered) * 0.08f;
+                    value = filtered * 3;
+                    break;
+            }
+            samples[i] = (sf::Int16) (std::max(-1.f, std::min(1.f, value * envelope)) * 16000);
+        }
+        return samples;
+    }
+}
+
+AudioDevice::~AudioDevice() {}
+
+SfmlAudioDevice::SfmlAudioDevice(int voice_count) :
+        buffers(Sounds::COUNT),
+        voices(voice_count)
+{}
+
+void SfmlAudioDevice::load(int sound, const std::vector<sf::Int16>& samples, unsigned sample_rate) {
+    buffers[sound].loadFromSamples(samples.data(), samples.size(), 1, sample_rate);
+}
+
+void SfmlAudioDevice::play(int voice, int sound, float volume, float pitch) {
+    sf::Sound& source = voices[voice];
+    source.stop();
+    source.setBuffer(buffers[sound]);
+    source.setVolume(volume);
+    source.setPitch(pitch);
+    source.play();
+}
+
+// sf::Music streams from disk on SFML's own thread.
+bool SfmlAudioDevice::play_music(std::string path, float volume) {
+    // The music track is optional, so a missing file is skipped quietly instead of logged by SFML.
+    if (!std::ifstream(path).good() || !music.openFromFile(path)) {
+        return false;
+    }
+    music.setLoop(true);
+    music.setVolume(volume);
+    music.play();
+    return true;
+}
+
+void SfmlAudioDevice::stop_music() {
+    music.stop();
+}
+
+void NullAudioDevice::load(int, const std::vector<sf::Int16>&, unsigned) {}
+
+void NullAudioDevice::play(int, int, float, float) {
+    plays += 1;
+}
+
+bool NullAudioDevice::play_music(std::string, float) {
+    return true;
+}
+
+void NullAudioDevice::stop_music() {}
+
+int NullAudioDevice::get_plays() const {
+    return plays;
+}
+
+AudioSystem::AudioSystem(AudioDevice& device, int voice_count, unsigned sample_rate) :
+        device(device),
+        voices(voice_count)
+{
+    MemoryScope scope(MemoryTags::AUDIO);
+    for (int sound = 0; sound < Sounds::COUNT; sound++) {
+        std::vector<sf::Int16> samples = synthesize(sound, sample_rate);
+        device.load(sound, samples, sample_rate);
+        durations.push_back(sf::seconds((float) samples.size() / sample_rate));
+    }
+}
+
+void AudioSystem::play(int sound, int count) {
+    pending[sound] += count;
+}
+
+// Events of one sound within a frame merge into a single voice that is louder the more there were.
+void AudioSystem::update(sf::Time now) {
+    std::uniform_real_distribution<float> pitch(1 - PITCH_VARIATION, 1 + PITCH_VARIATION);
+    for (int sound = Sounds::COUNT - 1; sound >= 0; sound--) {
+        int count = pending[sound];
+        if (!count) {
+            continue;
+        }
+        pending[sound] = 0;
+        int voice = find_voice(sound, now);
+        if (voice < 0) {
+            drops += 1;
+            continue;
+        }
+        float voice_pitch = pitch(random);
+        float volume = std::min(100.f, SOUNDS[sound].volume * (1 + 0.25f * std::log2((float) count)));
+        voices[voice].sound = sound;
+        voices[voice].start = now;
+        voices[voice].end = now + durations[sound] / voice_pitch;
+        device.play(voice, sound, volume, voice_pitch);
+        plays += 1;
+    }
+}
+
+bool AudioSystem::play_music(std::string path, float volume) {
+    return device.play_music(path, volume);
+}
+
+int AudioSystem::find_voice(int sound, sf::Time now) {
+    int idle = -1;
+    int same_count = 0;
+    int oldest_same = -1;
+    int victim = -1;
+    for (int i = 0; i < voices.size(); i++) {
+        const Voice& voice = voices[i];
+        if (voice.sound < 0 || voice.end <= now) {
+            idle = idle < 0 ? i : idle;
+            continue;
+        }
+        if (voice.sound == sound) {
+            same_count += 1;
+            if (oldest_same < 0 || voice.start < voices[oldest_same].start) {
+                oldest_same = i;
+            }
+        }
+        int priority = SOUNDS[voice.sound].priority;
+        if (priority <= SOUNDS[sound].priority
+            && (victim < 0 || priority < SOUNDS[voices[victim].sound].priority
+                || (priority == SOUNDS[voices[victim].sound].priority && voice.start < voices[victim].start))) {
+            victim = i;
+        }
+    }
+    if (same_count >= SOUNDS[sound].max_voices) {
+        steals += 1;
+        return oldest_same;
+    }
+    if (idle >= 0) {
+        return idle;
+    }
+    if (victim >= 0) {
+        steals += 1;
+    }
+    return victim;
+}
+
+int AudioSystem::get_active_voices(sf::Time now) const {
+    int active = 0;
+    for (const Voice& voice : voices) {
+        active += voice.sound >= 0 && voice.end > now;
+    }
+    return active;
+}
+
+int AudioSystem::get_plays() const {
+    return plays;
+}
+
+int AudioSystem::get_steals() const {
+    return steals;
+}
+
+int AudioSystem::get_drops() const {
+    return drops;
+}
@@ -0,0 +1,85 @@
+#ifndef GRAVITYARENA_AUDIO_H
+#define GRAVITYARENA_AUDIO_H
+
+#include <SFML/Audio.hpp>
+#include <random>
+#include <vector>
+
+namespace Sounds {
+    enum Enum {
+        SHOOT,
+        IMPACT,
+        HURT,
+        EXPLOSION,
+        COUNT
+    };
+}
+
+// Where voices actually play. The SFML device owns one shared buffer per sound and a fixed set of
+// sf::Sound voices; the null device plays nothing, so the mixing logic runs without audio hardware.
+class AudioDevice {
+public:
+    virtual ~AudioDevice();
+    virtual void load(int sound, const std::vector<sf::Int16>& samples, unsigned sample_rate) = 0;
+    virtual void play(int voice, int sound, float volume, float pitch) = 0;
+    virtual bool play_music(std::string path, float volume) = 0;
+    virtual void stop_music() = 0;
+};
+
+class SfmlAudioDevice : public AudioDevice {
+public:
+    SfmlAudioDevice(int voice_count);
+    virtual void load(int sound, const std::vector<sf::Int16>& samples, unsigned sample_rate);
+    virtual void play(int voice, int sound, float volume, float pitch);
+    virtual bool play_music(std::string path, float volume);
+    virtual void stop_music();
+private:
+    std::vector<sf::SoundBuffer> buffers;
+    std::vector<sf::Sound> voices;
+    sf::Music music;
+};
+
+class NullAudioDevice : public AudioDevice {
+public:
+    virtual void load(int sound, const std::vector<sf::Int16>& samples, unsigned sample_rate);
+    virtual void play(int voice, int sound, float volume, float pitch);
+    virtual bool play_music(std::string path, float volume);
+    virtual void stop_music();
+    int get_plays() const;
+private:
+    int plays = 0;
+};
+
+// Game code reports sound events as they happen; update() turns each frame's events into at most one
+// voice per sound, so the cost depends on the number of sound types, not on the fire rate. When every
+// voice is busy, a sound takes over the oldest voice of the lowest priority not above its own.
+class AudioSystem {
+public:
+    AudioSystem(AudioDevice& device, int voice_count, unsigned sample_rate);
+    void play(int sound, int count = 1);
+    void update(sf::Time now);
+    bool play_music(std::string path, float volume);
+    int get_active_voices(sf::Time now) const;
+    int get_plays() const;
+    int get_steals() const;
+    int get_drops() const;
+private:
+    struct Voice {
+        int sound = -1;
+        sf::Time start;
+        sf::Time end;
+    };
+
+    AudioDevice& device;
+    std::vector<Voice> voices;
+    std::vector<sf::Time> durations;
+    int pending[Sounds::COUNT] = {};
+    std::minstd_rand random;
+    int plays = 0;
+    int steals = 0;
+    int drops = 0;
+
+    int find_voice(int sound, sf::Time now);
+};
+
+#endif //GRAVITYARENA_AUDIO_H
@@ -0,0 +1,331 @@
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <random>
+#include <sstream>
+#include <thread>
+#include "game.h"
+#include "level.h"
+
+// Plays short headless bot-vs-bot matches over a sweep of tuning values on every core and writes
+// win rates, match length, planet crashes and orbit stability per configuration as CSV. Each match
+// is seeded from its position in the sweep, so the results do not depend on the thread count.
+
+namespace {
+    const float DANGER_DISTANCE = 60;
+    const float AIM_TOLERANCE = 5;
+    const float FIRE_TOLERANCE = 10;
+    const float THRUST_TOLERANCE = 45;
+    const float AIM_NOISE = 15;
+    const int JOB_CHUNK = 16;
+
+    float angle_to(sf::Vector2f offset) {
+        return to_degrees(std::atan2(offset.y, offset.x));
+    }
+
+    float length(sf::Vector2f vector) {
+        return std::sqrt(vector.x * vector.x + vector.y * vector.y);
+    }
+
+    // Steers away from planets it is falling into, otherwise turns towards the nearest opponent and fires.
+    struct Bot {
+        std::mt19937 random;
+        bool pressed[4] = {};
+        float aim_offset = 0;
+
+        Bot(unsigned seed) :
+                random(seed)
+        {}
+
+        void act(World& world, int index) {
+            const Player& self = world.get_players()[index];
+            if (!self.is_alive()) {
+                return;
+            }
+            sf::Vector2f position(self.get_coordinates());
+            sf::Vector2f velocity(self.get_velocity());
+            if (random() % FPS == 0) {
+                aim_offset = std::uniform_real_distribution<float>(-AIM_NOISE, AIM_NOISE)(random);
+            }
+
+            float heading = (float) self.get_rotation();
+            bool evading = false;
+            for (const Planet& planet : world.get_planets()) {
+                sf::Vector2f away = position - sf::Vector2f(planet.get_coordinates());
+                float distance = length(away);
+                float closing = -(velocity.x * away.x + velocity.y * away.y) / distance;
+                if (distance - (float) planet.shape().radius < DANGER_DISTANCE && closing > 0) {
+                    heading = angle_to(away);
+                    evading = true;
+                    break;
+                }
+            }
+            if (!evading) {
+                float nearest = -1;
+                for (const Player& other : world.get_players()) {
+                    sf::Vector2f offset = sf::Vector2f(other.get_coordinates()) - position;
+                    if (&other != &self && other.is_alive() && (nearest < 0 || length(offset) < nearest)) {
+                        nearest = length(offset);
+                        heading = angle_to(offset) + aim_offset;
+                    }
+                }
+            }
+
+            float difference = std::fmod(heading - (float) self.get_rotation() + 540.f, 360.f) - 180;
+            set(world, index, PlayerActions::ROTATE_RIGHT, difference > AIM_TOLERANCE);
+            set(world, index, PlayerActions::ROTATE_LEFT, difference < -AIM_TOLERANCE);
+            set(world, index, PlayerActions::ACCELERATE,
+                std::abs(difference) < THRUST_TOLERANCE && (evading || random() % 16 == 0));
+            set(world, index, PlayerActions::SHOOT, !evading && std::abs(difference) < FIRE_TOLERANCE);
+        }
+
+        void set(World& world, int index, int action, bool value) {
+            if (pressed[action] != value) {
+                pressed[action] = value;
+                world.handle_action(index, action, value);
+            }
+        }
+    };
+
+    struct Configuration {
+        int level;
+        Tuning tuning;
+    };
+
+    struct Totals {
+        long long matches = 0;
+        long long first_wins = 0;
+        long long second_wins = 0;
+        long long draws = 0;
+        long long timeouts = 0;
+        long long ticks = 0;
+        long long ships = 0;
+        long long crashes = 0;
+        double orbit_variation = 0;
+        long long orbits = 0;
+
+        void merge(const Totals& other) {
+            matches += other.matches;
+            first_wins += other.first_wins;
+            second_wins += other.second_wins;
+            draws += other.draws;
+            timeouts += other.timeouts;
+            ticks += other.ticks;
+            ships += other.ships;
+            crashes += other.crashes;
+            orbit_variation += other.orbit_variation;
+            orbits += other.orbits;
+        }
+    };
+
+    // Orbit stability is the coefficient of variation of each ship's distance to its nearest planet.
+    void play_match(const World& prototype, unsigned seed, int max_ticks, Totals& totals) {
+        World world = prototype;
+        std::vector<Player>& players = world.get_players();
+        std::vector<Bot> bots;
+        std::vector<bool> alive(players.size(), true);
+        std::vector<double> distance_sum(players.size());
+        std::vector<double> distance_square_sum(players.size());
+        std::vector<int> samples(players.size());
+        for (int i = 0; i < players.size(); i++) {
+            bots.push_back(Bot(seed * 31 + i));
+        }
+
+        int alive_count = (int) players.size();
+        while (world.get_tick() < max_ticks && alive_count > 1) {
+            for (int i = 0; i < players.size(); i++) {
+                bots[i].act(world, i);
+            }
+            world.tick();
+            for (int i = 0; i < players.size(); i++) {
+                if (alive[i] && !players[i].is_alive()) {
+                    alive[i] = false;
+                    alive_count -= 1;
+                    totals.crashes += !players[i].is_moving();
+                } else if (alive[i]) {
+                    float nearest = -1;
+                    for (const Planet& planet : world.get_planets()) {
+                        float distance = (float) find_distance(players[i].get_coordinates(), planet.get_coordinates());
+                        if (nearest < 0 || distance < nearest) {
+                            nearest = distance;
+                        }
+                    }
+                    distance_sum[i] += nearest;
+                    distance_square_sum[i] += nearest * nearest;
+                    samples[i] += 1;
+                }
+            }
+        }
+
+        totals.matches += 1;
+        totals.ticks += world.get_tick();
+        totals.ships += players.size();
+        if (alive_count > 1) {
+            totals.timeouts += 1;
+        } else if (alive_count == 0) {
+            totals.draws += 1;
+        } else if (alive[0]) {
+            totals.first_wins += 1;
+        } else if (alive[1]) {
+            totals.second_wins += 1;
+        }
+        for (int i = 0; i < players.size(); i++) {
+            if (samples[i] >= FPS) {
+                double mean = distance_sum[i] / samples[i];
+                double variance = std::max(0.0, distance_square_sum[i] / samples[i] - mean * mean);
+                totals.orbit_variation += std::sqrt(variance) / mean;
+                totals.orbits += 1;
+            }
+        }
+    }
+
+    std::vector<float> parse_list(std::string text) {
+        std::vector<float> values;
+        std::istringstream stream(text);
+        std::string value;
+        while (std::getline(stream, value, ',')) {
+            values.push_back((float) std::atof(value.c_str()));
+        }
+        return values;
+    }
+
+    void write_csv(std::ostream& stream, const std::vector<Configuration>& configurations,
+                   const std::vector<Totals>& totals) {
+        stream << "level,planet_mass,bullet_speed,movement_speed,matches,first_win_rate,second_win_rate,"
+                  "draw_rate,timeout_rate,mean_ticks,crash_rate,orbit_variation\n";
+        for (int i = 0; i < configurations.size(); i++) {
+            const Configuration& configuration = configurations[i];
+            const Totals& total = totals[i];
+            double matches = std::max<long long>(total.matches, 1);
+            stream << configuration.level << ","
+                   << configuration.tuning.planet_mass << ","
+                   << configuration.tuning.bullet_speed * FPS << ","
+                   << configuration.tuning.movement_speed * FPS << ","
+                   << total.matches << ","
+                   << total.first_wins / matches << ","
+                   << total.second_wins / matches << ","
+                   << total.draws / matches << ","
+                   << total.timeouts / matches << ","
+                   << total.ticks / matches << ","
+                   << total.crashes / (double) std::max<long long>(total.ships, 1) << ","
+                   << total.orbit_variation / std::max<long long>(total.orbits, 1) << "\n";
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    std::vector<float> levels = {0, 1};
+    std::vector<float> planet_masses = {3000};
+    std::vector<float> bullet_speeds = {500};
+    std::vector<float> movement_speeds = {1.5f};
+    int matches = 1000;
+    int ticks = FPS * 60;
+    unsigned seed = 1;
+    unsigned thread_count = std::max(1u, std::thread::hardware_concurrency());
+    std::string output_path = "balance.csv";
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string option = argv[i];
+        if (option == "--levels") {
+            levels = parse_list(argv[i + 1]);
+        } else if (option == "--planet-mass") {
+            planet_masses = parse_list(argv[i + 1]);
+        } else if (option == "--bullet-speed") {
+            bullet_speeds = parse_list(argv[i + 1]);
+        } else if (option == "--movement-speed") {
+            movement_speeds = parse_list(argv[i + 1]);
+        } else if (option == "--matches") {
+            matches = std::atoi(argv[i + 1]);
+        } else if (option == "--ticks") {
+            ticks = std::atoi(argv[i + 1]);
+        } else if (option == "--seed") {
+            seed = (unsigned) std::atoi(argv[i + 1]);
+        } else if (option == "--threads") {
+            thread_count = (unsigned) std::max(1, std::atoi(argv[i + 1]));
+        } else if (option == "--output") {
+            output_path = argv[i + 1];
+        } else {
+            std::cerr << "unknown option " << option << std::endl;
+            return 2;
+        }
+    }
+    for (float level : levels) {
+        if (level < 0 || level >= LEVEL_COUNT) {
+            std::cerr << "unknown level " << level << ", levels are 0 to " << LEVEL_COUNT - 1 << std::endl;
+            return 2;
+        }
+    }
+
+    // Speeds are given per second, as they read in level.cpp.
+    std::vector<Configuration> configurations;
+    for (float level : levels) {
+        for (float planet_mass : planet_masses) {
+            for (float bullet_speed : bullet_speeds) {
+                for (float movement_speed : movement_speeds) {
+                    Configuration configuration;
+                    configuration.level = (int) level;
+                    configuration.tuning.planet_mass = (int) planet_mass;
+                    configuration.tuning.bullet_speed = bullet_speed / FPS;
+                    configuration.tuning.movement_speed = movement_speed / FPS;
+                    configurations.push_back(configuration);
+                }
+            }
+        }
+    }
+
+    WorldSprites sprites = headless_sprites();
+    std::vector<World> prototypes;
+    for (const Configuration& configuration : configurations) {
+        prototypes.push_back(create_world(configuration.level, sprites, configuration.tuning));
+        // The trail is only a preview for the screen and never feeds back into the match.
+        for (Player& player : prototypes.back().get_players()) {
+            player.set_trail_length(0);
+        }
+    }
+
+    long long job_count = (long long) configurations.size() * matches;
+    std::atomic<long long> next_job(0);
+    std::vector<std::vector<Totals>> thread_totals(thread_count, std::vector<Totals>(configurations.size()));
+    std::vector<std::thread> workers;
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned t = 0; t < thread_count; t++) {
+        workers.push_back(std::thread([&, t]() {
+            for (long long first = next_job.fetch_add(JOB_CHUNK); first < job_count; first = next_job.fetch_add(JOB_CHUNK)) {
+                for (long long job = first; job < std::min(first + JOB_CHUNK, job_count); job++) {
+                    int configuration = (int) (job / matches);
+                    play_match(prototypes[configuration], seed + (unsigned) job, ticks, thread_totals[t][configuration]);
+                }
+            }
+        }));
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::vector<Totals> totals(configurations.size());
+    long long total_ticks = 0;
+    for (const std::vector<Totals>& worker_totals : thread_totals) {
+        for (int i = 0; i < configurations.size(); i++) {
+            totals[i].merge(worker_totals[i]);
+            total_ticks += worker_totals[i].ticks;
+        }
+    }
+
+    std::ofstream file(output_path);
+    write_csv(file, configurations, totals);
+    // Threads beyond the hardware's share cores, so the per-core rate divides by the cores actually used.
+    unsigned core_count = std::max(1u, std::min(thread_count, std::thread::hardware_concurrency()));
+    std::cout << std::fixed << std::setprecision(1)
+              << job_count << " matches, " << configurations.size() << " configurations, "
+              << thread_count << " threads on " << core_count << " cores, " << seconds << " s" << std::endl
+              << job_count / seconds / core_count << " matches/s/core, "
+              << total_ticks / seconds / core_count << " ticks/s/core, "
+              << (double) total_ticks / std::max<long long>(job_count, 1) << " ticks/match" << std::endl
+              << "wrote " << output_path << std::endl;
+    return 0;
+}
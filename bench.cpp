@@ -0,0 +1,428 @@
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <map>
+#include <random>
+#include <sstream>
+#include <thread>
+#include "allocations.h"
+#include "audio.h"
+#include "game.h"
+#include "level.h"
+#include "levelgenerator.h"
+
+// Headless performance scenarios over the real simulation code. Prints ns/tick, allocations/tick,
+// tick latency percentiles and the heap the world holds, and can save a JSON baseline or compare
+// against one.
+
+namespace {
+    struct Scenario {
+        int players;
+        int planets;
+        int bullet_lifetime;
+        int trail_length;
+        bool bullet_gravity;
+
+        std::string name() const {
+            std::ostringstream stream;
+            stream << "players=" << players << " planets=" << planets
+                   << " bullet_lifetime=" << bullet_lifetime << " trail=" << trail_length;
+            if (bullet_gravity) {
+                stream << " bullet_gravity";
+            }
+            return stream.str();
+        }
+    };
+
+    struct Result {
+        std::string name;
+        double ns_per_tick;
+        double p50;
+        double p90;
+        double p99;
+        double max;
+        double allocations_per_tick;
+        double bullets;
+        double memory_kb;
+        int ships_lost;
+    };
+
+    const int WARMUP_TICKS = 200;
+    const int MEASURED_TICKS = 200;
+
+    Result run_scenario(const Scenario& scenario, int repeat) {
+        WorldSprites sprites = headless_sprites();
+        std::vector<double> tick_times;
+        std::uint64_t allocations = 0;
+        double bullets = 0;
+        std::int64_t memory = 0;
+        int ships_lost = 0;
+        // Bullets still hit and are removed, but do no damage, so every ship is measured for the whole run.
+        Tuning tuning;
+        tuning.bullet_damage = 0;
+        for (int run = 0; run < repeat; run++) {
+            std::int64_t memory_before = Allocations::total();
+            World world = create_scenario(scenario.players, scenario.planets, sprites, tuning);
+            world.set_bullet_gravity(scenario.bullet_gravity);
+            std::vector<Player>& players = world.get_players();
+            for (int i = 0; i < players.size(); i++) {
+                players[i].set_trail_length(scenario.trail_length);
+                players[i].set_bullet_lifetime(scenario.bullet_lifetime);
+                world.handle_action(i, PlayerActions::ROTATE_RIGHT, true);
+                world.handle_action(i, PlayerActions::SHOOT, scenario.bullet_lifetime > 0);
+            }
+            for (int tick = 0; tick < WARMUP_TICKS; tick++) {
+                world.tick();
+            }
+            for (int tick = 0; tick < MEASURED_TICKS; tick++) {
+                std::uint64_t allocations_before = Allocations::count();
+                auto start = std::chrono::steady_clock::now();
+                world.tick();
+                auto end = std::chrono::steady_clock::now();
+                allocations += Allocations::count() - allocations_before;
+                tick_times.push_back((double) std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+                for (const Player& player : players) {
+                    bullets += player.bullet_count();
+                }
+            }
+            memory = std::max(memory, Allocations::total() - memory_before);
+            for (const Player& player : players) {
+                ships_lost += !player.is_alive();
+            }
+        }
+
+        Result result;
+        result.name = scenario.name();
+        double total = 0;
+        for (double time : tick_times) {
+            total += time;
+        }
+        std::sort(tick_times.begin(), tick_times.end());
+        result.ns_per_tick = total / tick_times.size();
+        result.p50 = tick_times[tick_times.size() / 2];
+        result.p90 = tick_times[tick_times.size() * 9 / 10];
+        result.p99 = tick_times[tick_times.size() * 99 / 100];
+        result.max = tick_times.back();
+        result.allocations_per_tick = (double) allocations / tick_times.size();
+        result.bullets = bullets / tick_times.size();
+        result.memory_kb = memory / 1024.0;
+        result.ships_lost = ships_lost;
+        return result;
+    }
+
+    // Checks every Collision specialisation against brute-force point sampling of random shape pairs.
+    int verify_collisions(int pairs) {
+        std::mt19937 random(1);
+        std::uniform_real_distribution<float> position(-40, 40);
+        std::uniform_real_distribution<float> size(1, 30);
+        std::uniform_real_distribution<float> angle(0, 360);
+        int missed = 0;
+        int sampled_misses = 0;
+        auto random_box = [&]() {
+            sf::Vector2f half_dimensions(size(random) / 2, size(random) / 2);
+            Scalar rotation = angle(random);
+            Vector axis(scalar_cos(rotation), scalar_sin(rotation));
+            Vector half(half_dimensions);
+            return OrientedBox{Vector(sf::Vector2f(position(random), position(random))), half, axis,
+                               scalar_sqrt(dot(half, half))};
+        };
+        auto random_circle = [&]() {
+            return Circle{Vector(sf::Vector2f(position(random), position(random))), Scalar(size(random) / 2)};
+        };
+        auto sampled = [](const sf::FloatRect& area, std::function<bool(Vector)> inside) {
+            for (float y = area.top; y <= area.top + area.height; y += 0.25f) {
+                for (float x = area.left; x <= area.left + area.width; x += 0.25f) {
+                    if (inside(Vector(sf::Vector2f(x, y)))) {
+                        return true;
+                    }
+                }
+            }
+            return false;
+        };
+        sf::FloatRect area(-60, -60, 120, 120);
+        for (int i = 0; i < pairs; i++) {
+            int kind = i % 3;
+            bool fast;
+            bool slow;
+            if (kind == 0) {
+                OrientedBox box_1 = random_box();
+                OrientedBox box_2 = random_box();
+                fast = intersects(box_1, box_2);
+                slow = sampled(area, [&](Vector point) { return contains(box_1, point) && contains(box_2, point); });
+            } else if (kind == 1) {
+                OrientedBox box = random_box();
+                Circle circle = random_circle();
+                fast = intersects(box, circle) && intersects(circle, box);
+                slow = sampled(area, [&](Vector point) { return contains(box, point) && contains(circle, point); });
+            } else {
+                Circle circle_1 = random_circle();
+                Circle circle_2 = random_circle();
+                fast = intersects(circle_1, circle_2);
+                slow = sampled(area, [&](Vector point) { return contains(circle_1, point) && contains(circle_2, point); });
+            }
+            if (slow && !fast) {
+                missed += 1;
+            } else if (fast && !slow) {
+                sampled_misses += 1;
+            }
+        }
+        std::cout << "collision verify: " << pairs << " pairs, " << missed << " missed overlaps, "
+                  << sampled_misses << " overlaps thinner than the sampling grid" << std::endl;
+        return missed > 0 || sampled_misses > pairs / 100;
+    }
+
+    void benchmark_collisions(int pairs) {
+        std::mt19937 random(2);
+        std::uniform_real_distribution<float> position(0, 200);
+        std::uniform_real_distribution<float> angle(0, 360);
+        std::vector<OrientedBox> boxes;
+        std::vector<Circle> circles;
+        for (int i = 0; i < pairs; i++) {
+            Scalar rotation = angle(random);
+            Vector half(sf::Vector2f(12.5f, 6.5f));
+            boxes.push_back({Vector(sf::Vector2f(position(random), position(random))), half,
+                             Vector(scalar_cos(rotation), scalar_sin(rotation)), scalar_sqrt(dot(half, half))});
+            circles.push_back({Vector(sf::Vector2f(position(random), position(random))), Scalar(42)});
+        }
+        int hits = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < pairs; i++) {
+            hits += intersects(boxes[i], boxes[(i + 1) % pairs]);
+        }
+        auto middle = std::chrono::steady_clock::now();
+        for (int i = 0; i < pairs; i++) {
+            hits += intersects(boxes[i], circles[i]);
+        }
+        auto end = std::chrono::steady_clock::now();
+        std::cout << std::fixed << std::setprecision(2)
+                  << "collision box/box " << std::chrono::duration<double, std::nano>(middle - start).count() / pairs
+                  << " ns, box/circle " << std::chrono::duration<double, std::nano>(end - middle).count() / pairs
+                  << " ns (" << hits << " hits)" << std::endl;
+    }
+
+    // Drives the voice pool with a null device at rising fire rates; the cost per frame and the number of
+    // voices started should stay flat however many events arrive.
+    void benchmark_audio(int frames) {
+        for (int rate : {1, 10, 100, 1000}) {
+            NullAudioDevice device;
+            AudioSystem audio(device, AUDIO_VOICES, AUDIO_SAMPLE_RATE);
+            std::uint64_t allocations = Allocations::count();
+            int max_active = 0;
+            auto start = std::chrono::steady_clock::now();
+            for (int frame = 0; frame < frames; frame++) {
+                sf::Time now = sf::seconds((float) frame / FPS);
+                audio.play(Sounds::SHOOT, rate);
+                audio.play(Sounds::IMPACT, rate / 4);
+                if (frame % 10 == 0) {
+                    audio.play(Sounds::HURT);
+                }
+                if (frame % 100 == 0) {
+                    audio.play(Sounds::EXPLOSION);
+                }
+                audio.update(now);
+                max_active = std::max(max_active, audio.get_active_voices(now));
+            }
+            auto end = std::chrono::steady_clock::now();
+            std::cout << std::fixed << std::setprecision(2)
+                      << "audio events/frame " << std::setw(5) << rate
+                      << " ns/frame " << std::setw(8) << std::chrono::duration<double, std::nano>(end - start).count() / frames
+                      << " voices started/frame " << std::setw(5) << (double) device.get_plays() / frames
+                      << " max active " << std::setw(3) << max_active
+                      << " steals " << std::setw(5) << audio.get_steals()
+                      << " drops " << std::setw(5) << audio.get_drops()
+                      << " allocs " << Allocations::count() - allocations << std::endl;
+        }
+    }
+
+    // Generates the same levels on one thread and on every core; the layouts must match exactly.
+    int benchmark_levels(int count) {
+        std::vector<std::vector<LevelLayout>> generated;
+        std::vector<unsigned> thread_counts = {1, std::max(2u, std::thread::hardware_concurrency())};
+        for (unsigned threads : thread_counts) {
+            LevelGenerator generator(LevelSettings(), Tuning(), threads);
+            auto start = std::chrono::steady_clock::now();
+            generated.push_back(generator.generate(1, count));
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            std::cout << std::fixed << std::setprecision(1)
+                      << "levels threads " << std::setw(3) << threads
+                      << " valid/s " << std::setw(9) << generated.back().size() / seconds
+                      << " candidates/s " << std::setw(9) << generator.get_candidates() / seconds
+                      << " accepted " << std::setw(5)
+                      << 100.0 * generator.get_rejections(LevelRejections::NONE) / generator.get_candidates() << " %";
+            for (int reason = 1; reason < LevelRejections::COUNT; reason++) {
+                std::cout << " " << LevelRejections::name(reason) << " " << generator.get_rejections(reason);
+            }
+            std::cout << std::endl;
+        }
+        bool identical = generated[0].size() == generated[1].size();
+        for (int i = 0; identical && i < generated[0].size(); i++) {
+            identical = identical && generated[0][i].seed == generated[1][i].seed
+                        && generated[0][i].planet_coordinates == generated[1][i].planet_coordinates
+                        && generated[0][i].player_coordinates == generated[1][i].player_coordinates;
+        }
+        std::cout << "levels " << (identical ? "identical" : "DIFFER") << " across thread counts" << std::endl;
+        return identical && generated[0].size() == count ? 0 : 1;
+    }
+
+    void save_baseline(const std::vector<Result>& results, std::string path) {
+        std::ofstream file(path);
+        file << std::fixed << std::setprecision(2) << "{\n  \"scenarios\": [\n";
+        for (int i = 0; i < results.size(); i++) {
+            const Result& result = results[i];
+            file << "    {\"name\": \"" << result.name << "\", \"ns_per_tick\": " << result.ns_per_tick
+                 << ", \"p50\": " << result.p50 << ", \"p90\": " << result.p90 << ", \"p99\": " << result.p99
+                 << ", \"max\": " << result.max << ", \"allocations_per_tick\": " << result.allocations_per_tick
+                 << ", \"memory_kb\": " << result.memory_kb << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+        }
+        file << "  ]\n}\n";
+    }
+
+    double json_number(const std::string& line, std::string key) {
+        size_t position = line.find("\"" + key + "\": ");
+        if (position == std::string::npos) {
+            return 0;
+        }
+        return std::atof(line.c_str() + position + key.size() + 4);
+    }
+
+    std::map<std::string, Result> load_baseline(std::string path) {
+        std::map<std::string, Result> results;
+        std::ifstream file(path);
+        std::string line;
+        while (std::getline(file, line)) {
+            size_t start = line.find("\"name\": \"");
+            if (start == std::string::npos) {
+                continue;
+            }
+            start += 9;
+            Result result;
+            result.name = line.substr(start, line.find('"', start) - start);
+            result.ns_per_tick = json_number(line, "ns_per_tick");
+            result.p99 = json_number(line, "p99");
+            result.allocations_per_tick = json_number(line, "allocations_per_tick");
+            result.memory_kb = json_number(line, "memory_kb");
+            results[result.name] = result;
+        }
+        return results;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    int repeat = 3;
+    double threshold = 0.1;
+    std::string save_path;
+    std::string compare_path;
+    bool verify = false;
+    bool audio = false;
+    bool levels = false;
+    bool bullet_gravity = false;
+    for (int i = 1; i < argc; i++) {
+        std::string option = argv[i];
+        if (option == "--verify") {
+            verify = true;
+        } else if (option == "--audio") {
+            audio = true;
+        } else if (option == "--levels") {
+            levels = true;
+        } else if (option == "--bullet-gravity") {
+            bullet_gravity = true;
+        } else if (option == "--repeat" && i + 1 < argc) {
+            repeat = std::atoi(argv[++i]);
+        } else if (option == "--threshold" && i + 1 < argc) {
+            threshold = std::atof(argv[++i]);
+        } else if (option == "--save" && i + 1 < argc) {
+            save_path = argv[++i];
+        } else if (option == "--compare" && i + 1 < argc) {
+            compare_path = argv[++i];
+        } else {
+            std::cerr << "usage: gravityarena_bench [--repeat N] [--save FILE] [--compare FILE] [--threshold F] [--verify] [--audio] [--levels] [--bullet-gravity]"
+                      << std::endl;
+            return 2;
+        }
+    }
+
+    if (verify) {
+        return verify_collisions(30000);
+    }
+    if (audio) {
+        benchmark_audio(10000);
+        return 0;
+    }
+    if (levels) {
+        return benchmark_levels(5000);
+    }
+
+    std::vector<Scenario> scenarios;
+    for (int players : {2, 8}) {
+        for (int planets : {1, 8, 32}) {
+            for (int bullet_lifetime : {0, 60, 200}) {
+                for (int trail_length : {TRAIL_LENGTH, TRAIL_LENGTH * 4}) {
+                    scenarios.push_back({players, planets, bullet_lifetime, trail_length, bullet_gravity});
+                }
+            }
+        }
+    }
+
+    std::map<std::string, Result> baseline;
+    if (!compare_path.empty()) {
+        baseline = load_baseline(compare_path);
+    }
+
+    benchmark_collisions(1000000);
+
+    std::vector<Result> results;
+    int regressions = 0;
+    int invalid = 0;
+    std::cout << std::fixed << std::setprecision(0);
+    for (const Scenario& scenario : scenarios) {
+        Result result = run_scenario(scenario, repeat);
+        results.push_back(result);
+        std::cout << std::setw(56) << std::left << result.name << std::right
+                  << " ns/tick " << std::setw(9) << result.ns_per_tick
+                  << " p50 " << std::setw(9) << result.p50
+                  << " p90 " << std::setw(9) << result.p90
+                  << " p99 " << std::setw(9) << result.p99
+                  << " max " << std::setw(9) << result.max
+                  << std::setprecision(1)
+                  << " allocs/tick " << std::setw(7) << result.allocations_per_tick
+                  << " bullets " << std::setw(6) << result.bullets
+                  << " kB " << std::setw(8) << result.memory_kb
+                  << std::setprecision(0);
+        if (result.ships_lost) {
+            std::cout << " " << result.ships_lost << " SHIPS LOST";
+            invalid += 1;
+        }
+        auto previous = baseline.find(result.name);
+        if (previous != baseline.end()) {
+            double change = result.ns_per_tick / previous->second.ns_per_tick - 1;
+            std::cout << " " << std::showpos << std::setprecision(1) << change * 100 << "%" << std::noshowpos
+                      << std::setprecision(0);
+            // Baselines saved before memory was tracked have no memory_kb and never flag it.
+            bool memory_grew = previous->second.memory_kb > 0
+                               && result.memory_kb > previous->second.memory_kb * (1 + threshold);
+            if (change > threshold || result.allocations_per_tick > previous->second.allocations_per_tick + 0.5
+                || memory_grew) {
+                std::cout << " REGRESSION";
+                regressions += 1;
+            }
+        }
+        std::cout << std::endl;
+    }
+
+    if (!save_path.empty()) {
+        save_baseline(results, save_path);
+    }
+    Allocations::report(std::cout);
+    if (!compare_path.empty()) {
+        std::cout << regressions << " regression(s) beyond " << threshold * 100 << "% against " << compare_path
+                  << std::endl;
+    }
+    if (invalid) {
+        std::cout << invalid << " scenario(s) lost ships and did not measure full worlds" << std::endl;
+    }
+    return regressions > 0 || invalid > 0;
+}
@@ -0,0 +1,69 @@
+#include "camera.h"
+#include "game.h"
+
+Camera::Camera(
+        sf::Vector2f dimensions,
+        sf::FloatRect bounds,
+        float min_zoom,
+        float max_zoom,
+        float margin
+) :
+        view(sf::Vector2f(bounds.left + bounds.width / 2, bounds.top + bounds.height / 2), dimensions),
+        dimensions(dimensions),
+        bounds(bounds),
+        min_zoom(min_zoom),
+        max_zoom(std::min(max_zoom, std::min(bounds.width / dimensions.x, bounds.height / dimensions.y))),
+        margin(margin)
+{}
+
+void Camera::follow(const std::vector<Player>& players) {
+    sf::Vector2f top_left(bounds.left + bounds.width, bounds.top + bounds.height);
+    sf::Vector2f bottom_right(bounds.left, bounds.top);
+    int count = 0;
+    for (const Player& player : players) {
+        if (player.is_active()) {
+            sf::Vector2f coordinates(player.get_coordinates());
+            top_left.x = std::min(top_left.x, coordinates.x);
+            top_left.y = std::min(top_left.y, coordinates.y);
+            bottom_right.x = std::max(bottom_right.x, coordinates.x);
+            bottom_right.y = std::max(bottom_right.y, coordinates.y);
+            count++;
+        }
+    }
+    if (!count) {
+        return;
+    }
+
+    sf::Vector2f target_center = (top_left + bottom_right) / 2.f;
+    float zoom_level = std::max((bottom_right.x - top_left.x + margin * 2) / dimensions.x,
+                                (bottom_right.y - top_left.y + margin * 2) / dimensions.y);
+    zoom_level = std::max(min_zoom, std::min(max_zoom, zoom_level + zoom_offset));
+
+    view.setCenter(view.getCenter() + (target_center - view.getCenter()) * CAMERA_SMOOTHING);
+    view.setSize(view.getSize() + (dimensions * zoom_level - view.getSize()) * CAMERA_SMOOTHING);
+    clamp_to_bounds();
+}
+
+void Camera::zoom(float delta) {
+    zoom_offset = std::max(min_zoom - max_zoom, std::min(max_zoom - min_zoom, zoom_offset - delta * CAMERA_ZOOM_STEP));
+}
+
+void Camera::apply(sf::RenderTarget& target) const {
+    target.setView(view);
+}
+
+const sf::View& Camera::get_view() const {
+    return view;
+}
+
+sf::FloatRect Camera::visible_area() const {
+    return sf::FloatRect(view.getCenter() - view.getSize() / 2.f, view.getSize());
+}
+
+void Camera::clamp_to_bounds() {
+    sf::Vector2f half_size = view.getSize() / 2.f;
+    sf::Vector2f center = view.getCenter();
+    center.x = std::max(bounds.left + half_size.x, std::min(bounds.left + bounds.width - half_size.x, center.x));
+    center.y = std::max(bounds.top + half_size.y, std::min(bounds.top + bounds.height - half_size.y, center.y));
+    view.setCenter(center);
+}
@@ -0,0 +1,31 @@
+#ifndef GRAVITYARENA_CAMERA_H
+#define GRAVITYARENA_CAMERA_H
+
+#include <SFML/Graphics.hpp>
+#include "classes.h"
+
+class Camera {
+public:
+    Camera(sf::Vector2f dimensions,
+           sf::FloatRect bounds,
+           float min_zoom,
+           float max_zoom,
+           float margin);
+    void follow(const std::vector<Player>& players);
+    void zoom(float delta);
+    void apply(sf::RenderTarget& target) const;
+    const sf::View& get_view() const;
+    sf::FloatRect visible_area() const;
+private:
+    sf::View view;
+    sf::Vector2f dimensions;
+    sf::FloatRect bounds;
+    float min_zoom;
+    float max_zoom;
+    float margin;
+    float zoom_offset = 0;
+
+    void clamp_to_bounds();
+};
+
+#endif //GRAVITYARENA_CAMERA_H
@@ -1,62 +1,83 @@
 #include "classes.h"
+#include "allocations.h"
 #include "game.h"
+#include "snapshot.h"
 
-Thing::Thing(sf::Vector2f coordinates, float rotation) :
+Thing::Thing(Vector coordinates, Scalar rotation) :
         coordinates(coordinates),
         rotation(rotation)
 {}
 
+Vector Thing::get_coordinates() const {
+    return coordinates;
+}
+
+void Thing::set_coordinates(Vector coordinates_p) {
+    coordinates = coordinates_p;
+}
+
+Scalar Thing::get_rotation() const {
+    return rotation;
+}
+
 RectHitBox::RectHitBox(sf::Vector2u dimensions) :
         dimensions(dimensions),
         default_dimensions(dimensions)
-{}
-
-bool RectHitBox::collided(const Hitbox& thing) const {
-    return thing.contains(coordinates)
-           || thing.contains(sf::Vector2f(coordinates.x + dimensions.x, coordinates.y))
-           || thing.contains(sf::Vector2f(coordinates.x, coordinates.y + dimensions.y))
-           || thing.contains(coordinates + dimensions);
+{
+    calculate_dimensions();
 }
 
-bool RectHitBox::contains(sf::Vector2f point) const {
-    return point.x >= coordinates.x && point.x < coordinates.x + dimensions.x
-           && point.y >= coordinates.y && point.y < coordinates.y + dimensions.y;
+bool RectHitBox::contains(Vector point) const {
+    return ::contains(shape(), point);
 }
 
 void RectHitBox::calculate_dimensions() {
-    dimensions.x = (float) (cos(to_radians(rotation)) * default_dimensions.x
-                            + cos(to_radians(90 - rotation)) * default_dimensions.y);
-    dimensions.y = (float) (sin(to_radians(rotation)) * default_dimensions.x
-                            + sin(to_radians(90 - rotation)) * default_dimensions.y);
+    axis = Vector(scalar_cos(rotation), scalar_sin(rotation));
+    dimensions.x = scalar_abs(axis.x) * default_dimensions.x + scalar_abs(axis.y) * default_dimensions.y;
+    dimensions.y = scalar_abs(axis.y) * default_dimensions.x + scalar_abs(axis.x) * default_dimensions.y;
+}
+
+OrientedBox RectHitBox::shape() const {
+    Vector half_dimensions = Vector(default_dimensions) / Scalar(2);
+    return {coordinates, half_dimensions, axis, scalar_sqrt(dot(half_dimensions, half_dimensions))};
+}
+
+sf::FloatRect RectHitBox::bounds() const {
+    return sf::FloatRect(sf::Vector2f(coordinates - dimensions / Scalar(2)), sf::Vector2f(dimensions));
 }
 
 CircleHitBox::CircleHitBox(int radius) :
         radius(radius)
 {}
 
-bool CircleHitBox::collided(const CircleHitBox& thing) const {
-    return thing.distance_to_center(coordinates) <= radius * 2;
+bool CircleHitBox::contains(Vector point) const {
+    return ::contains(shape(), point);
 }
 
-bool CircleHitBox::collided(const RectHitBox& thing) const {
-    return thing.collided(*this);
+Scalar CircleHitBox::distance_to_center(Vector point) const {
+    return find_distance(coordinates, point);
 }
 
-bool CircleHitBox::contains(sf::Vector2f point) const {
-    return distance_to_center(point) <= radius;
+Circle CircleHitBox::shape() const {
+    return {coordinates, Scalar(radius)};
 }
 
-float CircleHitBox::distance_to_center(sf::Vector2f point) const {
-    return find_distance(coordinates, point);
+sf::FloatRect CircleHitBox::bounds() const {
+    sf::Vector2f center(coordinates);
+    return sf::FloatRect(center.x - radius, center.y - radius, radius * 2, radius * 2);
 }
 
 void SpriteManager::update_transform() {
-    current_sprite().setPosition(coordinates);
-    current_sprite().setRotation(rotation);
+    current_sprite().setPosition(sf::Vector2f(coordinates));
+    current_sprite().setRotation((float) rotation);
 }
 
-void SpriteManager::display(sf::RenderWindow& window) {
-    window.draw(current_sprite());
+void SpriteManager::display(sf::RenderTarget& target) {
+    target.draw(current_sprite());
+}
+
+bool SpriteManager::is_visible(sf::FloatRect visible_area) {
+    return current_sprite().getGlobalBounds().intersects(visible_area);
 }
 
 SingleSpriteManager::SingleSpriteManager(sf::Sprite sprite) :
@@ -173,13 +194,17 @@ MassThing::MassThing(int mass) :
         mass(mass)
 {}
 
-float MassThing::find_force(sf::Vector2f target_coordinates, int target_mass) const {
-    return (float) (mass * target_mass * GRAVITY / std::pow(find_distance(coordinates, target_coordinates), 2));
+Scalar MassThing::find_force(Vector target_coordinates, int target_mass) const {
+    Scalar distance = find_distance(coordinates, target_coordinates);
+    return Scalar(mass * target_mass * GRAVITY) / (distance * distance);
+}
+
+int MassThing::get_mass() const {
+    return mass;
 }
 
-float MassThing::find_angle(const sf::Vector2f target_coordinates) const {
-    float degrees = to_degrees(
-            std::atan(std::abs((coordinates.y - target_coordinates.y) / (coordinates.x - target_coordinates.x))));
+Scalar MassThing::find_angle(const Vector target_coordinates) const {
+    Scalar degrees = scalar_atan(coordinates.y - target_coordinates.y, coordinates.x - target_coordinates.x);
     if (coordinates.x <= target_coordinates.x) {
         if (coordinates.y <= target_coordinates.y) {
             degrees += 180;
@@ -192,7 +217,7 @@ float MassThing::find_angle(const sf::Vector2f target_coordinates) const {
     return degrees;
 }
 
-MovingThing::MovingThing(sf::Vector2f velocity) :
+MovingThing::MovingThing(Vector velocity) :
         velocity(velocity)
 {}
 
@@ -200,7 +225,15 @@ void MovingThing::update_coordinates() {
     coordinates += velocity;
 }
 
-RotatingThing::RotatingThing(float rotation_velocity) :
+Vector MovingThing::get_velocity() const {
+    return velocity;
+}
+
+void MovingThing::set_velocity(Vector velocity_p) {
+    velocity = velocity_p;
+}
+
+RotatingThing::RotatingThing(Scalar rotation_velocity) :
         rotation_velocity(rotation_velocity)
 {}
 
@@ -214,20 +247,62 @@ void RotatingThing::update_rotation() {
 }
 
 Bullet::Bullet(
-        sf::Vector2f coordinates,
-        float rotation,
+        Vector coordinates,
+        Scalar rotation,
         sf::Vector2u dimensions,
         sf::Sprite sprite,
-        sf::Vector2f velocity
+        Vector velocity,
+        int lifetime,
+        const RotatedMasks* mask
 ) :
         Thing(coordinates, rotation),
         RectHitBox(dimensions),
         SingleSpriteManager(sprite),
-        MovingThing(velocity)
+        MovingThing(velocity),
+        lifetime(lifetime),
+        mask(mask)
 {}
 
+void Bullet::update_lifetime() {
+    lifetime -= 1;
+}
+
+bool Bullet::is_expired() const {
+    return lifetime <= 0;
+}
+
+// The boxes only reject; pixel masks, when loaded, decide the hits they let through.
+bool Bullet::hits(const Player& player) const {
+    if (!collided(player)) {
+        return false;
+    }
+    if (!mask || !player.get_mask()) {
+        return true;
+    }
+    Metrics::add(MetricCounters::MASK_TESTS);
+    return mask->overlaps(coordinates, rotation, *player.get_mask(), player.get_coordinates(), player.get_rotation());
+}
+
+bool Bullet::hits(const Planet& planet) const {
+    if (!collided(planet)) {
+        return false;
+    }
+    if (!mask) {
+        return true;
+    }
+    Metrics::add(MetricCounters::MASK_TESTS);
+    return mask->overlaps(coordinates, rotation, planet.get_coordinates(), planet.shape().radius);
+}
+
+void Bullet::hash(StateHash& hash) const {
+    hash.add(coordinates);
+    hash.add(velocity);
+    hash.add(rotation);
+    hash.add(lifetime);
+}
+
 Planet::Planet(
-        sf::Vector2f coordinates,
+        Vector coordinates,
         int radius,
         sf::Sprite sprite,
         int mass
@@ -235,19 +310,39 @@ Planet::Planet(
         Thing(coordinates),
         CircleHitBox(radius),
         SingleSpriteManager(sprite),
-        MassThing(mass)
+        MassThing(mass),
+        orbit(coordinates)
 {}
 
+void Planet::set_orbit(Orbit orbit_p) {
+    orbit = orbit_p;
+    coordinates = orbit.position(0);
+}
+
+bool Planet::is_orbiting() const {
+    return !orbit.is_static();
+}
+
+Vector Planet::position_at(int tick) const {
+    return orbit.position(tick);
+}
+
+void Planet::update_orbit(int tick) {
+    if (is_orbiting()) {
+        coordinates = orbit.position(tick);
+    }
+}
+
 Player::Player(
-        sf::Vector2f coordinates,
-        float rotation,
+        Vector coordinates,
+        Scalar rotation,
         sf::Vector2u dimensions,
         std::map<int, SpriteVector> sprites,
         int mass,
-        sf::Vector2f velocity,
-        float movement_speed,
-        float rotation_speed,
-        float bullet_speed,
+        Vector velocity,
+        Scalar movement_speed,
+        Scalar rotation_speed,
+        Scalar bullet_speed,
         sf::Sprite trail_sprite,
         sf::Sprite bullet_sprite,
         sf::Vector2u bullet_dimensions,
@@ -308,21 +403,43 @@ void Player::process_gravity(const MassThing& thing) {
     velocity += find_velocity((int) thing.find_angle(coordinates), thing.find_force(coordinates, mass));
 }
 
-void Player::update_gravity(const std::vector<MassThing>& things) {
+void Player::update_gravity(const ArenaVector<MassThing>& things) {
     for (const MassThing& mass_thing : things) {
         process_gravity(mass_thing);
     }
 }
 
-void Player::update_trail(const std::vector<Planet>& planets) {
+// tick is the one the first trail step simulates. Orbiting planets are moved to where they will be
+// at each step, so the prediction stays exact while the field changes.
+void Player::update_trail(const std::vector<Planet>& planets, const ArenaVector<MassThing>& masses, int tick) {
     trail.clear();
-    sf::Vector2f old_velocity = velocity;
-    sf::Vector2f old_coordinates = coordinates;
-    for (int i = 0; i != TRAIL_LENGTH; i++) {
-        update_gravity(std::vector<MassThing>(planets.begin(), planets.end()));
+    Vector old_velocity = velocity;
+    Vector old_coordinates = coordinates;
+    int steps = 0;
+    int collision_tests = 0;
+    bool orbiting = false;
+    for (const Planet& planet : planets) {
+        orbiting = orbiting || planet.is_orbiting();
+    }
+    ArenaVector<MassThing> future(masses.get_allocator());
+    if (orbiting) {
+        future.assign(masses.begin(), masses.end());
+    }
+    const ArenaVector<MassThing>& field = orbiting ? future : masses;
+    for (int i = 0; i != trail_length; i++) {
+        steps += 1;
+        if (orbiting) {
+            for (int j = 0; j < planets.size(); j++) {
+                future[j].set_coordinates(planets[j].position_at(tick + i));
+            }
+        }
+        update_gravity(field);
         update_coordinates();
-        for (const Planet& thing : planets) {
-            if (collided(thing)) {
+        for (int j = 0; j < planets.size(); j++) {
+            collision_tests += 1;
+            Circle circle = planets[j].shape();
+            circle.center = field[j].get_coordinates();
+            if (hits(circle)) {
                 goto end;
             }
         }
@@ -331,19 +448,30 @@ void Player::update_trail(const std::vector<Planet>& planets) {
     end:
     coordinates = old_coordinates;
     velocity = old_velocity;
+    Metrics::add(MetricCounters::TRAIL_STEPS, steps);
+    Metrics::add(MetricCounters::COLLISION_TESTS, collision_tests);
 }
 
-void Player::display_trail(sf::RenderWindow& window) {
-    for (sf::Vector2f coordinates : trail) {
-        trail_sprite.setPosition(coordinates);
-        window.draw(trail_sprite);
+void Player::display_trail(sf::RenderTarget& target, sf::FloatRect visible_area) {
+    for (Vector coordinates : trail) {
+        trail_sprite.setPosition(sf::Vector2f(coordinates));
+        if (trail_sprite.getGlobalBounds().intersects(visible_area)) {
+            target.draw(trail_sprite);
+        }
     }
 }
 
-void Player::update_bullets(RectHitBox display_hitbox) {
+void Player::update_bullets(sf::FloatRect world_bounds) {
+    int moved = batched_bullets;
+    batched_bullets = 0;
     for (auto it_bullet = bullets.begin(); it_bullet != bullets.end();) {
-        it_bullet->update_coordinates();
-        if (!it_bullet->collided(display_hitbox)) {
+        if (moved > 0) {
+            moved -= 1;
+        } else {
+            it_bullet->update_coordinates();
+        }
+        it_bullet->update_lifetime();
+        if (it_bullet->is_expired() || !world_bounds.contains(sf::Vector2f(it_bullet->get_coordinates()))) {
             it_bullet = bullets.erase(it_bullet);
         } else {
             ++it_bullet;
@@ -351,10 +479,28 @@ void Player::update_bullets(RectHitBox display_hitbox) {
     }
 }
 
-void Player::display_bullets(sf::RenderWindow& window) {
+void Player::gather_bullets(GravityBatch<Scalar>& batch) const {
+    for (const Bullet& bullet : bullets) {
+        batch.add(bullet.get_coordinates(), bullet.get_velocity());
+    }
+}
+
+int Player::scatter_bullets(const GravityBatch<Scalar>& batch, int offset) {
+    for (Bullet& bullet : bullets) {
+        bullet.set_coordinates(Vector(batch.x[offset], batch.y[offset]));
+        bullet.set_velocity(Vector(batch.velocity_x[offset], batch.velocity_y[offset]));
+        offset += 1;
+    }
+    batched_bullets = (int) bullets.size();
+    return offset;
+}
+
+void Player::display_bullets(sf::RenderTarget& target, sf::FloatRect visible_area) {
     for (Bullet& bullet : bullets) {
         bullet.update_transform();
-        bullet.display(window);
+        if (bullet.is_visible(visible_area)) {
+            bullet.display(target);
+        }
     }
 }
 
@@ -364,6 +510,21 @@ void Player::planet_collision() {
     moving = false;
 }
 
+bool Player::hits(const Planet& planet) const {
+    return hits(planet.shape());
+}
+
+bool Player::hits(const Circle& circle) const {
+    if (!intersects(shape(), circle)) {
+        return false;
+    }
+    if (!mask) {
+        return true;
+    }
+    Metrics::add(MetricCounters::MASK_TESTS);
+    return mask->overlaps(coordinates, rotation, circle.center, circle.radius);
+}
+
 void Player::accelerate(bool action) {
     accelerating = action;
     if (action) {
@@ -404,15 +565,19 @@ void Player::turn() {
 
 void Player::shoot() {
     if (shooting) {
+        MemoryScope scope(MemoryTags::BULLETS);
         bullets.push_back(
                 Bullet(
                         coordinates,
                         rotation,
                         bullet_dimensions,
                         bullet_sprite,
-                        find_velocity(rotation, bullet_speed)
+                        find_velocity(rotation, bullet_speed),
+                        bullet_lifetime,
+                        bullet_mask.get()
                 )
         );
+        shots += 1;
     }
 }
 
@@ -433,11 +598,13 @@ void Player::hurt(int damage) {
     if (!is_alive()) {
         sprite_type = PlayerSpriteTypes::EXPLODING;
     }
+    update_health_bar();
 }
 
 void Player::die() {
     health = 0;
     sprite_type = PlayerSpriteTypes::EXPLODING;
+    update_health_bar();
 }
 
 bool Player::is_moving() {
@@ -453,10 +620,14 @@ bool Player::operator!=(const Player& player) const {
 }
 
 void Player::bullet_collision(std::vector<Player>& players, std::vector<Planet>& planets) {
+    MemoryScope scope(MemoryTags::BULLETS);
+    int collision_tests = 0;
     for (auto it_bullet = bullets.begin(); it_bullet != bullets.end();) {
         for (Player& player2 : players) {
             if (*this != player2) {
-                if (it_bullet->collided(player2)) {
+                collision_tests += 1;
+                if (it_bullet->hits(player2)) {
+                    impacts.push_back({it_bullet->get_coordinates(), it_bullet->get_velocity()});
                     player2.hurt(bullet_damage);
                     it_bullet = bullets.erase(it_bullet);
                     goto end;
@@ -464,7 +635,9 @@ void Player::bullet_collision(std::vector<Player>& players, std::vector<Planet>&
             }
         }
         for (Planet& planet : planets) {
-            if (it_bullet->collided(planet)) {
+            collision_tests += 1;
+            if (it_bullet->hits(planet)) {
+                impacts.push_back({it_bullet->get_coordinates(), it_bullet->get_velocity()});
                 it_bullet = bullets.erase(it_bullet);
                 goto end;
             }
@@ -472,33 +645,31 @@ void Player::bullet_collision(std::vector<Player>& players, std::vector<Planet>&
         ++it_bullet;
         end:;
     }
+    Metrics::add(MetricCounters::COLLISION_TESTS, collision_tests);
 }
 
-void Player::display_health(sf::RenderWindow& window) const {
-    sf::Vector2f dimensions(sf::Vector2f(
-            health_bar_dimensions.x * ((float) health / original_health),
-            health_bar_dimensions.y
-    ));
-    sf::RectangleShape health_bar(dimensions);
-    sf::Vector2f border_dimensions(GUI_SCALE_FACTOR, dimensions.y);
-    sf::RectangleShape border(border_dimensions);
-    health_bar.setFillColor(health_bar_color);
-    border.setFillColor(sf::Color::Black);
-    health_bar.setPosition(health_bar_coordinates);
-    border.setPosition(health_bar_coordinates.x + dimensions.x * side * -1, health_bar_coordinates.y);
-    if (side == -1) {
-        dimensions.x = 0;
-        border_dimensions.x = 0;
-    }
-    health_bar.setOrigin(dimensions);
-    border.setOrigin(border_dimensions);
-    window.draw(health_bar);
-    window.draw(border);
+void Player::attach_hud(Hud& hud_p) {
+    hud = &hud_p;
+    hud_index = hud->add_bar(health_bar_coordinates, health_bar_dimensions, health_bar_color, side);
+    update_health_bar();
+}
+
+void Player::attach_particles(ParticleSystem& particles_p) {
+    particles = &particles_p;
+}
 
+void Player::attach_audio(AudioSystem& audio_p) {
+    audio = &audio_p;
 }
 
-void Player::display_health_box(sf::RenderWindow& window) const {
-    window.draw(health_bar_sprite);
+void Player::update_health_bar() {
+    if (hud) {
+        hud->update_bar(hud_index, (float) health / original_health);
+    }
+}
+
+void Player::display_health_box(sf::RenderTarget& target) const {
+    target.draw(health_bar_sprite);
 }
 
 void Player::end() {
@@ -507,4 +678,149 @@ void Player::end() {
 
 bool Player::is_active() const {
     return active;
+}
+
+void Player::set_trail_length(int length) {
+    trail_length = length;
+    reserve_storage();
+}
+
+void Player::set_bullet_lifetime(int lifetime) {
+    bullet_lifetime = lifetime;
+    reserve_storage();
+}
+
+void Player::set_masks(std::shared_ptr<const RotatedMasks> mask_p, std::shared_ptr<const RotatedMasks> bullet_mask_p) {
+    mask = mask_p;
+    bullet_mask = bullet_mask_p;
+}
+
+const RotatedMasks* Player::get_mask() const {
+    return mask.get();
+}
+
+// The trail never has more than trail_length points. A player shoots at most one bullet per tick and
+// the oldest expires only after the newest is fired, so bullet_lifetime + 1 can be alive at once.
+void Player::reserve_storage() {
+    {
+        MemoryScope scope(MemoryTags::TRAILS);
+        trail.reserve(trail_length);
+    }
+    MemoryScope scope(MemoryTags::BULLETS);
+    bullets.reserve(bullet_lifetime + 1);
+}
+
+int Player::bullet_count() const {
+    return (int) bullets.size();
+}
+
+const std::vector<Vector>& Player::get_trail() const {
+    return trail;
+}
+
+void Player::clear_impacts() {
+    impacts.clear();
+}
+
+void Player::capture(PlayerSnapshot& snapshot) const {
+    snapshot.coordinates = coordinates;
+    snapshot.velocity = velocity;
+    snapshot.rotation = rotation;
+    snapshot.sprite_type = sprite_type;
+    snapshot.sprite_index = sprite_index;
+    snapshot.health = health;
+    snapshot.accelerating = accelerating;
+    snapshot.moving = moving;
+    snapshot.active = active;
+    {
+        MemoryScope scope(MemoryTags::TRAILS);
+        snapshot.trail = trail;
+    }
+    {
+        MemoryScope scope(MemoryTags::BULLETS);
+        snapshot.bullets = bullets;
+        snapshot.impacts = impacts;
+    }
+    snapshot.shots = shots;
+}
+
+// Render-side copies of players are driven by snapshots and produce the cosmetic effects of what happened.
+void Player::apply_snapshot(const PlayerSnapshot& snapshot) {
+    bool was_alive = is_alive();
+    int old_health = health;
+    int new_shots = snapshot.shots - shots;
+    shots = snapshot.shots;
+    coordinates = snapshot.coordinates;
+    velocity = snapshot.velocity;
+    rotation = snapshot.rotation;
+    sprite_type = snapshot.sprite_type;
+    sprite_index = snapshot.sprite_index;
+    accelerating = snapshot.accelerating;
+    moving = snapshot.moving;
+    active = snapshot.active;
+    {
+        MemoryScope scope(MemoryTags::TRAILS);
+        trail = snapshot.trail;
+    }
+    {
+        MemoryScope scope(MemoryTags::BULLETS);
+        bullets = snapshot.bullets;
+    }
+    if (health != snapshot.health) {
+        health = snapshot.health;
+        update_health_bar();
+    }
+
+    if (particles) {
+        if (accelerating && is_alive()) {
+            particles->emit_thrust(sf::Vector2f(coordinates), (float) rotation, sf::Vector2f(velocity));
+        }
+        if (was_alive && !is_alive()) {
+            particles->emit_explosion(sf::Vector2f(coordinates), sf::Vector2f(velocity));
+        }
+        for (const Impact& impact : snapshot.impacts) {
+            particles->emit_impact(sf::Vector2f(impact.coordinates), sf::Vector2f(impact.velocity));
+        }
+    }
+    if (audio) {
+        if (new_shots > 0) {
+            audio->play(Sounds::SHOOT, new_shots);
+        }
+        if (!snapshot.impacts.empty()) {
+            audio->play(Sounds::IMPACT, (int) snapshot.impacts.size());
+        }
+        if (was_alive && !is_alive()) {
+            audio->play(Sounds::EXPLOSION);
+        } else if (health < old_health) {
+            audio->play(Sounds::HURT);
+        }
+    }
+}
+
+void Player::hash(StateHash& hash, int index) const {
+    hash.begin_field("coordinates", index);
+    hash.add(coordinates);
+    hash.begin_field("velocity", index);
+    hash.add(velocity);
+    hash.begin_field("rotation", index);
+    hash.add(rotation);
+    hash.add(rotation_velocity);
+    hash.begin_field("health", index);
+    hash.add(health);
+    hash.add(moving);
+    hash.add(active);
+    hash.begin_field("controls", index);
+    hash.add(accelerating);
+    hash.add(turning);
+    hash.add(turning_direction);
+    hash.add(shooting);
+    hash.begin_field("animation", index);
+    hash.add(sprite_type);
+    hash.add(sprite_index);
+    hash.add(sprite_count);
+    hash.begin_field("bullets", index);
+    hash.add((std::uint64_t) bullets.size());
+    for (const Bullet& bullet : bullets) {
+        bullet.hash(hash);
+    }
 }
\ No newline at end of file
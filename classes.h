@@ -2,47 +2,72 @@
 #define GRAVITYARENA_CLASSES_H
 
 #include <SFML/Graphics.hpp>
+#include "game.h"
+#include "hud.h"
+#include "particles.h"
+#include "audio.h"
+#include "collision.h"
+#include "statehash.h"
+#include "gravity.h"
+#include "metrics.h"
+#include "arena.h"
+#include "collisionmask.h"
+#include "orbit.h"
+#include <memory>
 
 typedef std::vector<sf::Sprite> SpriteVector;
 
+struct PlayerSnapshot;
+class Player;
+class Planet;
+
 class Thing {
 public:
-    Thing(sf::Vector2f coordinates = sf::Vector2f(), float rotation = float());
+    Thing(Vector coordinates = Vector(), Scalar rotation = Scalar());
+    Vector get_coordinates() const;
+    void set_coordinates(Vector coordinates);
+    Scalar get_rotation() const;
 protected:
-    sf::Vector2f coordinates;
-    float rotation;
-};
-
-class Hitbox : virtual public Thing {
-public:
-    virtual bool contains(sf::Vector2f point) const = 0;
+    Vector coordinates;
+    Scalar rotation;
 };
 
-class RectHitBox : public Hitbox {
+class RectHitBox : public virtual Thing {
 public:
     RectHitBox(sf::Vector2u dimensions);
-    bool collided(const Hitbox& thing) const;
-    virtual bool contains(sf::Vector2f point) const;
+    template <typename T>
+    bool collided(const T& thing) const {
+        return intersects(shape(), thing.shape());
+    }
+    bool contains(Vector point) const;
     void calculate_dimensions();
+    OrientedBox shape() const;
+    sf::FloatRect bounds() const;
 protected:
-    sf::Vector2f dimensions;
+    Vector dimensions;
     sf::Vector2u default_dimensions;
+    Vector axis;
 };
 
-class CircleHitBox : public Hitbox {
+class CircleHitBox : public virtual Thing {
 public:
     CircleHitBox(int radius);
-    bool collided(const CircleHitBox& thing) const;
-    bool collided(const RectHitBox& thing) const;
-    virtual bool contains(sf::Vector2f point) const;
-    float distance_to_center(sf::Vector2f point) const;
+    template <typename T>
+    bool collided(const T& thing) const {
+        return intersects(shape(), thing.shape());
+    }
+    bool contains(Vector point) const;
+    Scalar distance_to_center(Vector point) const;
+    Circle shape() const;
+    sf::FloatRect bounds() const;
 protected:
     int radius;
 };
 
 class SpriteManager : virtual public Thing {
 public:
-    virtual void display(sf::RenderWindow& window);
+    virtual void display(sf::RenderTarget& target);
+    bool is_visible(sf::FloatRect visible_area);
     virtual void update_transform();
 protected:
     virtual sf::Sprite& current_sprite() = 0;
@@ -115,56 +140,81 @@ protected:
 class MassThing : public virtual Thing {
 public:
     MassThing(int mass);
-    float find_force(sf::Vector2f coordinates, int mass) const;
-    float find_angle(sf::Vector2f coordinates) const;
+    Scalar find_force(Vector coordinates, int mass) const;
+    Scalar find_angle(Vector coordinates) const;
+    int get_mass() const;
 protected:
     int mass;
 };
 
 class MovingThing : public virtual Thing {
 public:
-    MovingThing(sf::Vector2f velocity = sf::Vector2f());
+    MovingThing(Vector velocity = Vector());
     void update_coordinates();
+    Vector get_velocity() const;
+    void set_velocity(Vector velocity);
 protected:
-    sf::Vector2f velocity;
+    Vector velocity;
 };
 
 class RotatingThing : public virtual Thing {
 public:
-    RotatingThing(float rotation_velocity = 0);
+    RotatingThing(Scalar rotation_velocity = 0);
     void update_rotation();
 protected:
-    float rotation_velocity;
+    Scalar rotation_velocity;
 };
 
 class Bullet : public SingleSpriteManager, public RectHitBox, public MovingThing {
 public:
-    Bullet(sf::Vector2f coordinates,
-           float rotation,
+    Bullet(Vector coordinates,
+           Scalar rotation,
            sf::Vector2u dimensions,
            sf::Sprite sprite,
-           sf::Vector2f velocity);
+           Vector velocity,
+           int lifetime = BULLET_LIFETIME,
+           const RotatedMasks* mask = nullptr);
+    void update_lifetime();
+    bool is_expired() const;
+    bool hits(const Player& player) const;
+    bool hits(const Planet& planet) const;
+    bool hits(const Circle& circle) const;
+    void hash(StateHash& hash) const;
+private:
+    int lifetime;
+    const RotatedMasks* mask;
 };
 
 class Planet : public SingleSpriteManager, public CircleHitBox, public MassThing {
 public:
-    Planet(sf::Vector2f coordinates,
+    Planet(Vector coordinates,
            int radius,
            sf::Sprite sprite,
            int mass);
+    void set_orbit(Orbit orbit);
+    bool is_orbiting() const;
+    Vector position_at(int tick) const;
+    void update_orbit(int tick);
+private:
+    Orbit orbit;
+};
+
+struct Impact {
+    Vector coordinates;
+    Vector velocity;
 };
 
 class Player : public ComplexMultiSpriteManager, public RectHitBox, public MassThing, public MovingThing, public RotatingThing {
 public:
-    Player(sf::Vector2f coordinates,
-           float rotation,
+    Player(Vector coordinates,
+           Scalar rotation,
            sf::Vector2u dimensions,
            std::map<int, SpriteVector> sprites,
            int mass,
-           sf::Vector2f velocity,
-           float movement_speed,
-           float rotation_speed,
-           float bullet_speed,
+           Vector velocity,
+           Scalar movement_speed,
+           Scalar rotation_speed,
+           Scalar bullet_speed,
            sf::Sprite trail_sprite,
            sf::Sprite bullet_sprite,
            sf::Vector2u bullet_dimensions,
@@ -179,12 +229,16 @@ public:
            sf::Sprite health_bar_sprite
     );
     void process_gravity(const MassThing& thing);
-    void update_gravity(const std::vector<MassThing>& things);
-    void update_trail(const std::vector<Planet>& planets);
-    void display_trail(sf::RenderWindow& window);
-    void update_bullets(RectHitBox display_hitbox);
-    void display_bullets(sf::RenderWindow& window);
+    void update_gravity(const ArenaVector<MassThing>& things);
+    void update_trail(const std::vector<Planet>& planets, const ArenaVector<MassThing>& masses, int tick);
+    void display_trail(sf::RenderTarget& target, sf::FloatRect visible_area);
+    void update_bullets(sf::FloatRect world_bounds);
+    void gather_bullets(GravityBatch<Scalar>& batch) const;
+    int scatter_bullets(const GravityBatch<Scalar>& batch, int offset);
+    void display_bullets(sf::RenderTarget& target, sf::FloatRect visible_area);
     void planet_collision();
+    bool hits(const Planet& planet) const;
+    bool hits(const Circle& circle) const;
 
     void accelerate(bool action);
     void turn(bool action, int direction);
@@ -206,25 +260,45 @@ public:
     bool operator!=(const Player& player) const;
 
     void bullet_collision(std::vector<Player>& players, std::vector<Planet>& planets);
-    void display_health(sf::RenderWindow& window) const;
-    void display_health_box(sf::RenderWindow& window) const;
+    void attach_hud(Hud& hud);
+    void attach_particles(ParticleSystem& particles);
+    void attach_audio(AudioSystem& audio);
+    void display_health_box(sf::RenderTarget& target) const;
     void end();
     bool is_active() const;
+    void hash(StateHash& hash, int index) const;
+
+    void set_trail_length(int length);
+    void set_bullet_lifetime(int lifetime);
+    int bullet_count() const;
+    const std::vector<Vector>& get_trail() const;
+    void reserve_storage();
+    void set_masks(std::shared_ptr<const RotatedMasks> mask, std::shared_ptr<const RotatedMasks> bullet_mask);
+    const RotatedMasks* get_mask() const;
+
+    void clear_impacts();
+    void capture(PlayerSnapshot& snapshot) const;
+    void apply_snapshot(const PlayerSnapshot& snapshot);
 
 private:
-    float movement_speed;
-    float rotation_speed;
-    float bullet_speed;
-    std::vector<sf::Vector2f> trail;
+    Scalar movement_speed;
+    Scalar rotation_speed;
+    Scalar bullet_speed;
+    std::vector<Vector> trail;
     sf::Sprite trail_sprite;
     sf::Sprite bullet_sprite;
     sf::Vector2u bullet_dimensions;
-    int turning_direction;
+    int turning_direction = int();
     std::map<int, int> controls;
     int original_health;
     int health;
     std::vector<Bullet> bullets;
+    std::vector<Impact> impacts;
     int bullet_damage;
+    int trail_length = TRAIL_LENGTH;
+    int bullet_lifetime = BULLET_LIFETIME;
+    // Leading bullets the world's gravity batch has already moved this tick.
+    int batched_bullets = 0;
 
     bool accelerating = false;
     bool turning = false;
@@ -237,6 +311,15 @@ private:
     int side;
     sf::Vector2f health_bar_coordinates;
     sf::Sprite health_bar_sprite;
+    Hud* hud = nullptr;
+    int hud_index = int();
+    ParticleSystem* particles = nullptr;
+    AudioSystem* audio = nullptr;
+    int shots = 0;
+    std::shared_ptr<const RotatedMasks> mask;
+    std::shared_ptr<const RotatedMasks> bullet_mask;
+
+    void update_health_bar();
 };
 
 #endif
@@ -0,0 +1,102 @@
+#ifndef GRAVITYARENA_COLLISION_H
+#define GRAVITYARENA_COLLISION_H
+
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include "numeric.h"
+
+struct OrientedBox {
+    Vector center;
+    Vector half_dimensions;
+    Vector axis;
+    Scalar bounding_radius;
+};
+
+struct Circle {
+    Vector center;
+    Scalar radius;
+};
+
+inline Scalar dot(Vector vector_1, Vector vector_2) {
+    return vector_1.x * vector_2.x + vector_1.y * vector_2.y;
+}
+
+inline Vector perpendicular(Vector vector) {
+    return Vector(-vector.y, vector.x);
+}
+
+inline bool bounding_circles_overlap(Vector center_1, Scalar radius_1, Vector center_2, Scalar radius_2) {
+    Vector offset = center_2 - center_1;
+    return dot(offset, offset) <= (radius_1 + radius_2) * (radius_1 + radius_2);
+}
+
+inline bool contains(const OrientedBox& box, Vector point) {
+    Vector offset = point - box.center;
+    return scalar_abs(dot(offset, box.axis)) <= box.half_dimensions.x
+           && scalar_abs(dot(offset, perpendicular(box.axis))) <= box.half_dimensions.y;
+}
+
+inline bool contains(const Circle& circle, Vector point) {
+    Vector offset = point - circle.center;
+    return dot(offset, offset) <= circle.radius * circle.radius;
+}
+
+template <typename Shape1, typename Shape2>
+struct Collision;
+
+template <>
+struct Collision<Circle, Circle> {
+    static bool test(const Circle& circle_1, const Circle& circle_2) {
+        return bounding_circles_overlap(circle_1.center, circle_1.radius, circle_2.center, circle_2.radius);
+    }
+};
+
+template <>
+struct Collision<OrientedBox, Circle> {
+    static bool test(const OrientedBox& box, const Circle& circle) {
+        if (!bounding_circles_overlap(box.center, box.bounding_radius, circle.center, circle.radius)) {
+            return false;
+        }
+        Vector offset = circle.center - box.center;
+        Vector local(dot(offset, box.axis), dot(offset, perpendicular(box.axis)));
+        Vector closest(std::max(-box.half_dimensions.x, std::min(box.half_dimensions.x, local.x)),
+                             std::max(-box.half_dimensions.y, std::min(box.half_dimensions.y, local.y)));
+        Vector distance = local - closest;
+        return dot(distance, distance) <= circle.radius * circle.radius;
+    }
+};
+
+template <>
+struct Collision<Circle, OrientedBox> {
+    static bool test(const Circle& circle, const OrientedBox& box) {
+        return Collision<OrientedBox, Circle>::test(box, circle);
+    }
+};
+
+template <>
+struct Collision<OrientedBox, OrientedBox> {
+    static bool test(const OrientedBox& box_1, const OrientedBox& box_2) {
+        if (!bounding_circles_overlap(box_1.center, box_1.bounding_radius, box_2.center, box_2.bounding_radius)) {
+            return false;
+        }
+        Vector offset = box_2.center - box_1.center;
+        Vector axes[4] = {box_1.axis, perpendicular(box_1.axis), box_2.axis, perpendicular(box_2.axis)};
+        for (Vector axis : axes) {
+            Scalar extent_1 = scalar_abs(dot(axes[0], axis)) * box_1.half_dimensions.x
+                             + scalar_abs(dot(axes[1], axis)) * box_1.half_dimensions.y;
+            Scalar extent_2 = scalar_abs(dot(axes[2], axis)) * box_2.half_dimensions.x
+                             + scalar_abs(dot(axes[3], axis)) * box_2.half_dimensions.y;
+            if (scalar_abs(dot(offset, axis)) > extent_1 + extent_2) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+template <typename Shape1, typename Shape2>
+inline bool intersects(const Shape1& shape_1, const Shape2& shape_2) {
+    return Collision<Shape1, Shape2>::test(shape_1, shape_2);
+}
+
+#endif //GRAVITYARENA_COLLISION_H
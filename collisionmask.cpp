@@ -0,0 +1,166 @@
+#include <cmath>
+#include "collisionmask.h"
+#include "game.h"
+
+CollisionMask::CollisionMask(int width, int height) :
+        width(width),
+        height(height),
+        words_per_row((width + 63) / 64),
+        bits(words_per_row * height)
+{}
+
+CollisionMask CollisionMask::from_alpha(const sf::Image& image, sf::IntRect area, sf::Uint8 threshold) {
+    CollisionMask mask(area.width, area.height);
+    for (int y = 0; y < area.height; y++) {
+        for (int x = 0; x < area.width; x++) {
+            if (image.getPixel(area.left + x, area.top + y).a > threshold) {
+                mask.set(x, y);
+            }
+        }
+    }
+    return mask;
+}
+
+// Samples back into this mask for every destination pixel, so the result has no holes. Sampling is
+// done in Scalar with the deterministic trigonometry, so fixed-point builds get the same bits everywhere.
+CollisionMask CollisionMask::rotated(Scalar degrees, Scalar scale) const {
+    int size = (int) std::ceil(std::sqrt((float) (width * width + height * height)) * (float) scale) + 1;
+    CollisionMask mask(size, size);
+    Scalar cosine = scalar_cos(degrees);
+    Scalar sine = scalar_sin(degrees);
+    Scalar center = Scalar(size) / Scalar(2);
+    for (int y = 0; y < size; y++) {
+        Scalar dy = (Scalar(y) + Scalar(0.5f) - center) / scale;
+        for (int x = 0; x < size; x++) {
+            Scalar dx = (Scalar(x) + Scalar(0.5f) - center) / scale;
+            Scalar source_x = cosine * dx + sine * dy + Scalar(width) / Scalar(2);
+            Scalar source_y = -sine * dx + cosine * dy + Scalar(height) / Scalar(2);
+            if (source_x >= Scalar(0) && source_y >= Scalar(0) && get((int) source_x, (int) source_y)) {
+                mask.set(x, y);
+            }
+        }
+    }
+    return mask;
+}
+
+void CollisionMask::set(int x, int y) {
+    bits[y * words_per_row + x / 64] |= std::uint64_t(1) << (x % 64);
+}
+
+bool CollisionMask::get(int x, int y) const {
+    if (x < 0 || y < 0 || x >= width || y >= height) {
+        return false;
+    }
+    return (bits[y * words_per_row + x / 64] >> (x % 64)) & 1;
+}
+
+int CollisionMask::get_width() const {
+    return width;
+}
+
+int CollisionMask::get_height() const {
+    return height;
+}
+
+int CollisionMask::count() const {
+    int total = 0;
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            total += get(x, y);
+        }
+    }
+    return total;
+}
+
+// other's top left corner sits at (offset_x, offset_y) in this mask's pixels.
+bool CollisionMask::overlaps(const CollisionMask& other, int offset_x, int offset_y) const {
+    int first_row = std::max(0, offset_y);
+    int last_row = std::min(height, offset_y + other.height);
+    int first_word = std::max(0, offset_x) / 64;
+    int last_word = (std::min(width, offset_x + other.width) + 63) / 64;
+    for (int y = first_row; y < last_row; y++) {
+        for (int i = first_word; i < last_word; i++) {
+            if (word(y, i) & other.row_bits(y - offset_y, i * 64 - offset_x)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+// center is in this mask's pixels; a pixel counts when its center lies inside the circle.
+bool CollisionMask::overlaps(sf::Vector2f center, float radius) const {
+    int first_row = std::max(0, (int) std::floor(center.y - radius));
+    int last_row = std::min(height - 1, (int) std::ceil(center.y + radius));
+    for (int y = first_row; y <= last_row; y++) {
+        float dy = y + 0.5f - center.y;
+        float chord = radius * radius - dy * dy;
+        if (chord < 0) {
+            continue;
+        }
+        float half = std::sqrt(chord);
+        int first = std::max(0, (int) std::ceil(center.x - half - 0.5f));
+        int last = std::min(width - 1, (int) std::floor(center.x + half - 0.5f));
+        for (int x = first; x <= last; x += 64) {
+            int span = std::min(64, last - x + 1);
+            std::uint64_t range = span == 64 ? ~std::uint64_t(0) : (std::uint64_t(1) << span) - 1;
+            if (row_bits(y, x) & range) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+std::uint64_t CollisionMask::word(int row, int index) const {
+    if (index < 0 || index >= words_per_row) {
+        return 0;
+    }
+    return bits[row * words_per_row + index];
+}
+
+// The 64 pixels of a row starting at column x, which may lie partly outside the mask.
+std::uint64_t CollisionMask::row_bits(int row, int x) const {
+    if (row < 0 || row >= height || x >= width || x <= -64) {
+        return 0;
+    }
+    int index = x >= 0 ? x / 64 : -1;
+    int shift = x - index * 64;
+    std::uint64_t low = word(row, index) >> shift;
+    std::uint64_t high = shift ? word(row, index + 1) << (64 - shift) : 0;
+    return low | high;
+}
+
+RotatedMasks::RotatedMasks(const CollisionMask& mask, float scale, int buckets) {
+    for (int i = 0; i < buckets; i++) {
+        masks.push_back(mask.rotated(Scalar(360 * i) / Scalar(buckets), Scalar(scale)));
+    }
+}
+
+const CollisionMask& RotatedMasks::get(Scalar rotation) const {
+    int buckets = (int) masks.size();
+    int bucket = (int) (rotation * Scalar(buckets) / Scalar(360) + Scalar(0.5f)) % buckets;
+    if (bucket < 0) {
+        bucket += buckets;
+    }
+    return masks[bucket];
+}
+
+bool RotatedMasks::overlaps(Vector center, Scalar rotation, const RotatedMasks& other, Vector other_center,
+                            Scalar other_rotation) const {
+    const CollisionMask& mask = get(rotation);
+    const CollisionMask& other_mask = other.get(other_rotation);
+    sf::Vector2i offset = top_left(other_mask, other_center) - top_left(mask, center);
+    return mask.overlaps(other_mask, offset.x, offset.y);
+}
+
+bool RotatedMasks::overlaps(Vector center, Scalar rotation, Vector circle_center, Scalar radius) const {
+    const CollisionMask& mask = get(rotation);
+    sf::Vector2f relative = sf::Vector2f(circle_center) - sf::Vector2f(top_left(mask, center));
+    return mask.overlaps(relative, (float) radius);
+}
+
+sf::Vector2i RotatedMasks::top_left(const CollisionMask& mask, Vector center) {
+    return sf::Vector2i((int) std::floor((float) center.x - mask.get_width() / 2.f),
+                        (int) std::floor((float) center.y - mask.get_height() / 2.f));
+}
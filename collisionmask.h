@@ -0,0 +1,46 @@
+#ifndef GRAVITYARENA_COLLISIONMASK_H
+#define GRAVITYARENA_COLLISIONMASK_H
+
+#include <SFML/Graphics.hpp>
+#include <cstdint>
+#include <vector>
+#include "numeric.h"
+
+// One bit per pixel, rows packed into 64-bit words so overlap tests compare 64 pixels at a time.
+class CollisionMask {
+public:
+    CollisionMask(int width = 0, int height = 0);
+    static CollisionMask from_alpha(const sf::Image& image, sf::IntRect area, sf::Uint8 threshold = 0);
+    CollisionMask rotated(Scalar degrees, Scalar scale) const;
+    void set(int x, int y);
+    bool get(int x, int y) const;
+    int get_width() const;
+    int get_height() const;
+    int count() const;
+    bool overlaps(const CollisionMask& other, int offset_x, int offset_y) const;
+    bool overlaps(sf::Vector2f center, float radius) const;
+private:
+    int width;
+    int height;
+    int words_per_row;
+    std::vector<std::uint64_t> bits;
+
+    std::uint64_t word(int row, int index) const;
+    std::uint64_t row_bits(int row, int x) const;
+};
+
+// A mask pre-rotated into fixed angle buckets, each centered on the sprite's origin.
+class RotatedMasks {
+public:
+    RotatedMasks(const CollisionMask& mask, float scale, int buckets);
+    const CollisionMask& get(Scalar rotation) const;
+    bool overlaps(Vector center, Scalar rotation, const RotatedMasks& other, Vector other_center,
+                  Scalar other_rotation) const;
+    bool overlaps(Vector center, Scalar rotation, Vector circle_center, Scalar radius) const;
+private:
+    std::vector<CollisionMask> masks;
+
+    static sf::Vector2i top_left(const CollisionMask& mask, Vector center);
+};
+
+#endif //GRAVITYARENA_COLLISIONMASK_H
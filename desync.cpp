@@ -0,0 +1,209 @@
+#include <SFML/Graphics.hpp>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <random>
+#include <sstream>
+#include "game.h"
+#include "level.h"
+
+// Runs matches with scripted inputs and reports the first tick and state field at which two
+// simulations disagree, either side by side in this process or against a hash log recorded
+// by another build or machine.
+
+namespace {
+    struct ScriptedInput {
+        std::mt19937 random;
+        std::vector<std::vector<bool>> pressed;
+
+        ScriptedInput(unsigned seed, int players) :
+                random(seed),
+                pressed(players, std::vector<bool>(4, false))
+        {}
+
+        void apply(World& world) {
+            std::vector<Player>& players = world.get_players();
+            for (int i = 0; i < players.size(); i++) {
+                if (random() % 8 == 0 && players[i].is_alive()) {
+                    toggle(world, i, random() % 4);
+                }
+            }
+        }
+
+        void toggle(World& world, int player, int action) {
+            pressed[player][action] = !pressed[player][action];
+            world.handle_action(player, action, pressed[player][action]);
+        }
+    };
+
+    std::string field_name(const StateField& field) {
+        std::ostringstream name;
+        if (field.index >= 0) {
+            name << "player[" << field.index << "].";
+        }
+        name << field.name;
+        return name.str();
+    }
+
+    std::string hex(std::uint64_t value) {
+        std::ostringstream stream;
+        stream << std::hex << std::setw(16) << std::setfill('0') << value;
+        return stream.str();
+    }
+
+    void report_fields(int tick, const std::vector<StateField>& fields, const std::vector<StateField>& other_fields) {
+        std::cout << "desync at tick " << tick << std::endl;
+        for (int i = 0; i < fields.size() || i < other_fields.size(); i++) {
+            if (i >= fields.size() || i >= other_fields.size()) {
+                std::cout << "  field count differs (" << fields.size() << " vs " << other_fields.size() << ")" << std::endl;
+                break;
+            }
+            if (fields[i].hash != other_fields[i].hash) {
+                std::cout << "  " << field_name(fields[i]) << ": " << hex(fields[i].hash)
+                          << " vs " << hex(other_fields[i].hash) << std::endl;
+            }
+        }
+    }
+
+    int run_side_by_side(int level, const WorldSprites& sprites, int ticks, unsigned seed, int perturb_tick) {
+        World world = create_world(level, sprites);
+        World other_world = world;
+        ScriptedInput input(seed, (int) world.get_players().size());
+        ScriptedInput other_input(seed, (int) other_world.get_players().size());
+        for (int tick = 0; tick < ticks; tick++) {
+            input.apply(world);
+            other_input.apply(other_world);
+            if (tick == perturb_tick && other_world.get_players()[0].is_alive()) {
+                other_input.toggle(other_world, 0, PlayerActions::ACCELERATE);
+            }
+            world.tick();
+            other_world.tick();
+            if (world.get_hash() != other_world.get_hash()) {
+                std::vector<StateField> fields;
+                std::vector<StateField> other_fields;
+                world.hash_fields(fields);
+                other_world.hash_fields(other_fields);
+                report_fields(world.get_tick(), fields, other_fields);
+                return 1;
+            }
+        }
+        std::cout << "no desync in " << ticks << " ticks, final hash " << hex(world.get_hash()) << std::endl;
+        return 0;
+    }
+
+    int run_record(int level, const WorldSprites& sprites, int ticks, unsigned seed, std::string path) {
+        std::ofstream file(path);
+        World world = create_world(level, sprites);
+        ScriptedInput input(seed, (int) world.get_players().size());
+        std::vector<StateField> fields;
+        for (int tick = 0; tick < ticks; tick++) {
+            input.apply(world);
+            world.tick();
+            fields.clear();
+            world.hash_fields(fields);
+            file << world.get_tick() << " " << hex(world.get_hash());
+            for (const StateField& field : fields) {
+                file << " " << field.name << ":" << field.index << ":" << hex(field.hash);
+            }
+            file << "\n";
+        }
+        std::cout << "recorded " << ticks << " ticks to " << path << std::endl;
+        return 0;
+    }
+
+    int run_compare(int level, const WorldSprites& sprites, int ticks, unsigned seed, std::string path) {
+        std::ifstream file(path);
+        World world = create_world(level, sprites);
+        ScriptedInput input(seed, (int) world.get_players().size());
+        std::string line;
+        for (int tick = 0; tick < ticks && std::getline(file, line); tick++) {
+            input.apply(world);
+            world.tick();
+
+            std::istringstream stream(line);
+            int recorded_tick;
+            std::string recorded_hash;
+            stream >> recorded_tick >> recorded_hash;
+            if (recorded_hash == hex(world.get_hash())) {
+                continue;
+            }
+
+            std::vector<StateField> fields;
+            world.hash_fields(fields);
+            std::vector<StateField> recorded_fields;
+            std::vector<std::string> names;
+            std::string token;
+            while (stream >> token) {
+                size_t first = token.find(':');
+                size_t second = token.find(':', first + 1);
+                names.push_back(token.substr(0, first));
+                recorded_fields.push_back({nullptr, std::atoi(token.substr(first + 1, second - first - 1).c_str()),
+                                           std::strtoull(token.substr(second + 1).c_str(), nullptr, 16)});
+            }
+            for (int i = 0; i < recorded_fields.size(); i++) {
+                recorded_fields[i].name = names[i].c_str();
+            }
+            report_fields(world.get_tick(), fields, recorded_fields);
+            return 1;
+        }
+        std::cout << "matches " << path << " through tick " << world.get_tick() << std::endl;
+        return 0;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    int level = 1;
+    int ticks = FPS * 60;
+    unsigned seed = 1;
+    int perturb_tick = -1;
+    std::string record_path;
+    std::string compare_path;
+    std::string mask_directory;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string option = argv[i];
+        if (option == "--level") {
+            level = std::atoi(argv[i + 1]);
+        } else if (option == "--ticks") {
+            ticks = std::atoi(argv[i + 1]);
+        } else if (option == "--seed") {
+            seed = (unsigned) std::atoi(argv[i + 1]);
+        } else if (option == "--perturb") {
+            perturb_tick = std::atoi(argv[i + 1]);
+        } else if (option == "--record") {
+            record_path = argv[i + 1];
+        } else if (option == "--compare") {
+            compare_path = argv[i + 1];
+        } else if (option == "--masks") {
+            mask_directory = argv[i + 1];
+        } else {
+            std::cerr << "unknown option " << option << std::endl;
+            return 2;
+        }
+    }
+    if (level < 0 || level >= LEVEL_COUNT) {
+        std::cerr << "unknown level " << level << ", levels are 0 to " << LEVEL_COUNT - 1 << std::endl;
+        return 2;
+    }
+
+    // With --masks, hits are refined by the pixel masks cut from the sprite sheets in that directory,
+    // so the hash also covers mask collisions. Only the images are decoded; no window is needed.
+    WorldSprites sprites = headless_sprites();
+    if (!mask_directory.empty()) {
+        sf::Image ship_sheet;
+        sf::Image misc_sheet;
+        if (!ship_sheet.loadFromFile(mask_directory + "/ship_sheet.png")
+                || !misc_sheet.loadFromFile(mask_directory + "/misc_sheet.png")) {
+            std::cerr << "cannot load the sprite sheets in " << mask_directory << std::endl;
+            return 2;
+        }
+        sprites = headless_sprites(ship_sheet, misc_sheet);
+    }
+
+    if (!record_path.empty()) {
+        return run_record(level, sprites, ticks, seed, record_path);
+    }
+    if (!compare_path.empty()) {
+        return run_compare(level, sprites, ticks, seed, compare_path);
+    }
+    return run_side_by_side(level, sprites, ticks, seed, perturb_tick);
+}
@@ -0,0 +1,34 @@
+#include <SFML/Graphics.hpp>
+#include "game.h"
+
+void print_nums(sf::Vector2f vector) {
+    printf("%f, %f \n", vector.x, vector.y);
+}
+
+void print_nums(sf::Vector2i vector) {
+    printf("%i, %i \n", vector.x, vector.y);
+}
+
+void print_nums(sf::Vector2u vector) {
+    printf("%u, %u \n", vector.x, vector.y);
+}
+
+float to_radians(float degrees) {
+    return degrees * (PI / 180);
+}
+
+float to_degrees(float radians) {
+    return radians * (180 / PI);
+}
+
+Scalar find_distance(Vector coordinates_1, Vector coordinates_2) {
+    Vector offset = coordinates_1 - coordinates_2;
+    return scalar_sqrt(offset.x * offset.x + offset.y * offset.y);
+}
+
+Vector find_velocity(Scalar angle, Scalar force) {
+    Vector velocity;
+    velocity.x = scalar_cos(angle) * force;
+    velocity.y = scalar_sin(angle) * force;
+    return velocity;
+}
@@ -4,6 +4,7 @@
 //#include <SFML/Graphics.hpp>
 
 #include <iostream>
+#include "numeric.h"
 
 namespace PlayerSpriteTypes {
     enum Enum {
@@ -30,11 +31,50 @@ const int SCALE_FACTOR = 1;
 const int GUI_SCALE_FACTOR = 4  ;
 const unsigned FPS = 30;
 const sf::Vector2u DISPLAY_DIMENSIONS(1920, 1080);
+const sf::Vector2u WORLD_DIMENSIONS(3840, 2160);
+const unsigned WORLD_CELL_SIZE = 256;
+const int BULLET_LIFETIME = FPS * 4;
+const float CAMERA_MIN_ZOOM = 0.5f;
+const float CAMERA_MAX_ZOOM = 2;
+const float CAMERA_MARGIN = 300;
+const float CAMERA_SMOOTHING = 0.1f;
+const float CAMERA_ZOOM_STEP = 0.1f;
+const float RENDER_SCALE_MIN = 0.5f;
+const float RENDER_SCALE_MAX = 1;
+const float RENDER_SCALE_STEP = 0.05f;
+const float RENDER_SCALE_SMOOTHING = 0.1f;
+const float RENDER_SCALE_HEADROOM = 0.7f;
+const float RENDER_FRAME_BUDGET = 0.8f;
+const int PARTICLE_CAPACITY = 1 << 17;
+const float PARTICLE_SIZE = 3 * SCALE_FACTOR;
+const int PARTICLE_MASS = 10;
+const bool BULLET_GRAVITY = false;
+const int BULLET_MASS = 5;
+const std::size_t FRAME_ARENA_SIZE = 64 * 1024;
+const int INPUT_QUEUE_SIZE = 256;
+const int MAX_PARTICLE_STEPS = 4;
+const int LATENCY_SAMPLES = 1000;
+const float LOW_LATENCY_MARGIN = 0.002f;
+const float LOW_LATENCY_DECAY = 0.95f;
+const unsigned short METRICS_PORT = 9180;
+const std::string METRICS_DUMP_PATH = "metrics.json";
+const float METRICS_DUMP_INTERVAL = 10;
+const int MASK_ROTATIONS = 64;
+const sf::Uint8 MASK_ALPHA_THRESHOLD = 0;
+const unsigned short RELAY_PORT = 9181;
+const int RELAY_MAX_QUEUED_FRAMES = 8;
+const int AUDIO_VOICES = 16;
+const unsigned AUDIO_SAMPLE_RATE = 44100;
+const std::string MUSIC_PATH = "music.ogg";
+const float MUSIC_VOLUME = 40;
+const sf::Keyboard::Key MEMORY_OVERLAY_KEY = sf::Keyboard::F3;
+const sf::Vector2f MEMORY_OVERLAY_COORDINATES(20, 20);
+const sf::Vector2f MEMORY_OVERLAY_ROW(400, 12);
 
 float to_radians(float degrees);
 float to_degrees(float radians);
-float find_distance(sf::Vector2f coordinates_1, sf::Vector2f coordinates_2);
-sf::Vector2f find_velocity(float angle, float force);
+Scalar find_distance(Vector coordinates_1, Vector coordinates_2);
+Vector find_velocity(Scalar angle, Scalar force);
 
 void print_nums(sf::Vector2f vector);
 void print_nums(sf::Vector2i vector);
@@ -0,0 +1,72 @@
+#ifndef GRAVITYARENA_GRAVITY_H
+#define GRAVITYARENA_GRAVITY_H
+
+#include <SFML/Graphics.hpp>
+#include <cmath>
+#include <vector>
+#include "numeric.h"
+
+inline float gravity_sqrt(float value) {
+    return std::sqrt(value);
+}
+
+#ifdef GRAVITYARENA_FIXED_POINT
+inline Fixed gravity_sqrt(Fixed value) {
+    return scalar_sqrt(value);
+}
+#endif
+
+// Pulls every body towards one source with strength / distance^2. The loop body is branch free so it
+// vectorizes for floats, and the operation order keeps fixed-point intermediates in range.
+template <typename T>
+void apply_gravity(T source_x, T source_y, T strength, const T* x, const T* y, T* velocity_x, T* velocity_y,
+                   int count) {
+    for (int i = 0; i < count; i++) {
+        T dx = source_x - x[i];
+        T dy = source_y - y[i];
+        T distance_squared = dx * dx + dy * dy + T(1);
+        T distance = gravity_sqrt(distance_squared);
+        velocity_x[i] += dx * strength / distance_squared / distance;
+        velocity_y[i] += dy * strength / distance_squared / distance;
+    }
+}
+
+template <typename T>
+struct GravityBatch {
+    std::vector<T> x;
+    std::vector<T> y;
+    std::vector<T> velocity_x;
+    std::vector<T> velocity_y;
+
+    void clear() {
+        x.clear();
+        y.clear();
+        velocity_x.clear();
+        velocity_y.clear();
+    }
+
+    void add(sf::Vector2<T> coordinates, sf::Vector2<T> velocity) {
+        x.push_back(coordinates.x);
+        y.push_back(coordinates.y);
+        velocity_x.push_back(velocity.x);
+        velocity_y.push_back(velocity.y);
+    }
+
+    int size() const {
+        return (int) x.size();
+    }
+
+    void apply(T source_x, T source_y, T strength) {
+        apply_gravity(source_x, source_y, strength, x.data(), y.data(), velocity_x.data(), velocity_y.data(), size());
+    }
+
+    // Moves every body by its velocity once all the sources have pulled on it.
+    void integrate() {
+        for (int i = 0; i < size(); i++) {
+            x[i] += velocity_x[i];
+            y[i] += velocity_y[i];
+        }
+    }
+};
+
+#endif //GRAVITYARENA_GRAVITY_H
@@ -0,0 +1,48 @@
+#include "hud.h"
+#include "allocations.h"
+#include "game.h"
+
+Hud::Hud() :
+        vertices(sf::Quads)
+{}
+
+int Hud::add_bar(sf::Vector2f coordinates, sf::Vector2u dimensions, sf::Color color, int side) {
+    MemoryScope scope(MemoryTags::HUD);
+    bars.push_back({coordinates, sf::Vector2f(dimensions), side});
+    vertices.resize(bars.size() * 8);
+    int index = (int) bars.size() - 1;
+    for (int i = 0; i < 4; i++) {
+        vertices[index * 8 + i].color = color;
+        vertices[index * 8 + 4 + i].color = sf::Color::Black;
+    }
+    update_bar(index, 1);
+    return index;
+}
+
+void Hud::update_bar(int index, float fraction) {
+    const Bar& bar = bars[index];
+    float width = bar.dimensions.x * std::max(0.f, fraction);
+    float top = bar.coordinates.y - bar.dimensions.y;
+    if (width <= 0) {
+        set_quad(index * 2, bar.coordinates.x, top, 0, 0);
+        set_quad(index * 2 + 1, bar.coordinates.x, top, 0, 0);
+    } else if (bar.side == -1) {
+        set_quad(index * 2, bar.coordinates.x, top, width, bar.dimensions.y);
+        set_quad(index * 2 + 1, bar.coordinates.x + width, top, GUI_SCALE_FACTOR, bar.dimensions.y);
+    } else {
+        set_quad(index * 2, bar.coordinates.x - width, top, width, bar.dimensions.y);
+        set_quad(index * 2 + 1, bar.coordinates.x - width - GUI_SCALE_FACTOR, top, GUI_SCALE_FACTOR, bar.dimensions.y);
+    }
+}
+
+void Hud::display(sf::RenderTarget& target) const {
+    target.draw(vertices);
+}
+
+void Hud::set_quad(int index, float left, float top, float width, float height) {
+    sf::Vertex* quad = &vertices[index * 4];
+    quad[0].position = sf::Vector2f(left, top);
+    quad[1].position = sf::Vector2f(left + width, top);
+    quad[2].position = sf::Vector2f(left + width, top + height);
+    quad[3].position = sf::Vector2f(left, top + height);
+}
@@ -0,0 +1,25 @@
+#ifndef GRAVITYARENA_HUD_H
+#define GRAVITYARENA_HUD_H
+
+#include <SFML/Graphics.hpp>
+
+class Hud {
+public:
+    Hud();
+    int add_bar(sf::Vector2f coordinates, sf::Vector2u dimensions, sf::Color color, int side);
+    void update_bar(int index, float fraction);
+    void display(sf::RenderTarget& target) const;
+private:
+    struct Bar {
+        sf::Vector2f coordinates;
+        sf::Vector2f dimensions;
+        int side;
+    };
+
+    std::vector<Bar> bars;
+    sf::VertexArray vertices;
+
+    void set_quad(int index, float left, float top, float width, float height);
+};
+
+#endif //GRAVITYARENA_HUD_H
@@ -0,0 +1,55 @@
+#include <algorithm>
+#include <iomanip>
+#include "latency.h"
+#include "metrics.h"
+
+LatencyTracker::LatencyTracker(int sample_count) :
+        sample_count(sample_count)
+{
+    samples.reserve(sample_count);
+}
+
+void LatencyTracker::begin_poll(sf::Time time) {
+    arrival = previous_poll + (time - previous_poll) / 2.f;
+    previous_poll = time;
+}
+
+int LatencyTracker::record() {
+    pending.push_back({next_sequence, arrival});
+    return next_sequence++;
+}
+
+void LatencyTracker::reflect(int sequence) {
+    reflected = std::max(reflected, sequence);
+}
+
+void LatencyTracker::present(sf::Time time) {
+    int presented = 0;
+    while (presented < pending.size() && pending[presented].sequence <= reflected) {
+        float latency = (time - pending[presented].arrival).asSeconds();
+        Metrics::observe(MetricHistograms::INPUT_LATENCY, latency);
+        if (samples.size() < sample_count) {
+            samples.push_back(latency * 1000);
+        } else {
+            samples[next_sample] = latency * 1000;
+            next_sample = (next_sample + 1) % sample_count;
+        }
+        presented += 1;
+    }
+    pending.erase(pending.begin(), pending.begin() + presented);
+}
+
+void LatencyTracker::report(std::ostream& stream) const {
+    if (samples.empty()) {
+        return;
+    }
+    std::vector<float> sorted = samples;
+    std::sort(sorted.begin(), sorted.end());
+    float total = 0;
+    for (float sample : sorted) {
+        total += sample;
+    }
+    stream << std::fixed << std::setprecision(1) << "input latency over " << sorted.size() << " events: mean "
+           << total / sorted.size() << " ms, p50 " << sorted[sorted.size() / 2] << " ms, p95 "
+           << sorted[sorted.size() * 95 / 100] << " ms, max " << sorted.back() << " ms" << std::endl;
+}
@@ -0,0 +1,35 @@
+#ifndef GRAVITYARENA_LATENCY_H
+#define GRAVITYARENA_LATENCY_H
+
+#include <SFML/System.hpp>
+#include <ostream>
+#include <vector>
+
+// Measures input-to-photon latency: the time from a key event to the presented frame whose snapshot
+// first includes it. SFML events carry no timestamp, so an event is taken to have arrived halfway
+// between the poll that returned it and the previous one.
+class LatencyTracker {
+public:
+    LatencyTracker(int sample_count);
+    void begin_poll(sf::Time time);
+    int record();
+    void reflect(int sequence);
+    void present(sf::Time time);
+    void report(std::ostream& stream) const;
+private:
+    struct Input {
+        int sequence;
+        sf::Time arrival;
+    };
+
+    std::vector<Input> pending;
+    std::vector<float> samples;
+    int sample_count;
+    int next_sample = 0;
+    int next_sequence = 1;
+    int reflected = 0;
+    sf::Time previous_poll;
+    sf::Time arrival;
+};
+
+#endif //GRAVITYARENA_LATENCY_H
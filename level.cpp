@@ -0,0 +1,256 @@
+#include <algorithm>
+#include "level.h"
+#include "allocations.h"
+#include "game.h"
+
+namespace {
+    const sf::Vector2u PLAYER_DIMENSIONS(25, 13);
+    const sf::Vector2u EXPLOSION_DIMENSIONS(31, 19);
+    const int ANIMATION_LENGTH = 4;
+    const sf::Vector2u TRAIL_DIMENSIONS(4, 4);
+    const sf::Vector2u BULLET_DIMENSIONS(8, 3);
+    const sf::Vector2u HEALTH_BAR_DIMENSIONS(128, 19);
+    const sf::Vector2u PLANET_DIMENSIONS(84, 84);
+    const int PLAYER_COUNT = 2;
+}
+
+WorldSprites load_sprites(SpriteSheet& ship_sheet, SpriteSheet& planet_sheet, SpriteSheet& misc_sheet) {
+    MemoryScope scope(MemoryTags::ASSETS);
+    WorldSprites sprites;
+    std::map<int, SpriteVector> player_sprites;
+    for (int i = 0; i < PLAYER_COUNT; i++) {
+        player_sprites[PlayerSpriteTypes::IDLE] = ship_sheet.get_sprites(PLAYER_DIMENSIONS);
+        player_sprites[PlayerSpriteTypes::ACCELERATING] = ship_sheet.get_custom_sprites(PLAYER_DIMENSIONS, ANIMATION_LENGTH);
+        player_sprites[PlayerSpriteTypes::EXPLODING] = ship_sheet.get_custom_sprites(EXPLOSION_DIMENSIONS, ANIMATION_LENGTH);
+        sprites.players.push_back(player_sprites);
+    }
+    sprites.trail = misc_sheet.get_sprites(TRAIL_DIMENSIONS)[0];
+    sprites.bullet = misc_sheet.get_sprites(BULLET_DIMENSIONS)[0];
+    sprites.health_bar = misc_sheet.get_sprites(HEALTH_BAR_DIMENSIONS, 0, GUI_SCALE_FACTOR)[0];
+    sprites.planet = planet_sheet.get_sprites(PLANET_DIMENSIONS)[0];
+
+    const sf::Sprite& ship = sprites.players[0][PlayerSpriteTypes::IDLE][0];
+    sprites.ship_mask = std::make_shared<RotatedMasks>(ship_sheet.get_mask(ship, MASK_ALPHA_THRESHOLD),
+                                                       ship.getScale().x, MASK_ROTATIONS);
+    sprites.bullet_mask = std::make_shared<RotatedMasks>(misc_sheet.get_mask(sprites.bullet, MASK_ALPHA_THRESHOLD),
+                                                         sprites.bullet.getScale().x, MASK_ROTATIONS);
+    return sprites;
+}
+
+WorldSprites headless_sprites() {
+    WorldSprites sprites;
+    std::map<int, SpriteVector> player_sprites;
+    player_sprites[PlayerSpriteTypes::IDLE] = SpriteVector(1);
+    player_sprites[PlayerSpriteTypes::ACCELERATING] = SpriteVector(ANIMATION_LENGTH);
+    player_sprites[PlayerSpriteTypes::EXPLODING] = SpriteVector(ANIMATION_LENGTH);
+    sprites.players = std::vector<std::map<int, SpriteVector>>(PLAYER_COUNT, player_sprites);
+    return sprites;
+}
+
+// Adds the collision masks load_sprites would build, cut from the sheet images at the same places,
+// so headless tools can hit test with masks without a window or textures.
+WorldSprites headless_sprites(const sf::Image& ship_sheet, const sf::Image& misc_sheet) {
+    MemoryScope scope(MemoryTags::ASSETS);
+    WorldSprites sprites = headless_sprites();
+    float scale = (float) std::max(1, SCALE_FACTOR);
+    sf::IntRect ship_area(0, 0, PLAYER_DIMENSIONS.x, PLAYER_DIMENSIONS.y);
+    sf::IntRect bullet_area(0, TRAIL_DIMENSIONS.y, BULLET_DIMENSIONS.x, BULLET_DIMENSIONS.y);
+    sprites.ship_mask = std::make_shared<RotatedMasks>(
+            CollisionMask::from_alpha(ship_sheet, ship_area, MASK_ALPHA_THRESHOLD), scale, MASK_ROTATIONS);
+    sprites.bullet_mask = std::make_shared<RotatedMasks>(
+            CollisionMask::from_alpha(misc_sheet, bullet_area, MASK_ALPHA_THRESHOLD), scale, MASK_ROTATIONS);
+    return sprites;
+}
+
+namespace {
+    Player create_player(int index, Vector coordinates, Scalar rotation, Vector velocity, const WorldSprites& sprites,
+                         const Tuning& tuning) {
+        std::vector<std::map<int, int>> player_controls(2);
+        player_controls[0][sf::Keyboard::W] = PlayerActions::ACCELERATE;
+        player_controls[0][sf::Keyboard::D] = PlayerActions::ROTATE_RIGHT;
+        player_controls[0][sf::Keyboard::A] = PlayerActions::ROTATE_LEFT;
+        player_controls[0][sf::Keyboard::Q] = PlayerActions::SHOOT;
+        player_controls[1][sf::Keyboard::Up] = PlayerActions::ACCELERATE;
+        player_controls[1][sf::Keyboard::Right] = PlayerActions::ROTATE_RIGHT;
+        player_controls[1][sf::Keyboard::Left] = PlayerActions::ROTATE_LEFT;
+        player_controls[1][sf::Keyboard::Slash] = PlayerActions::SHOOT;
+
+        std::vector<sf::Color> health_bar_color = {sf::Color(162, 69, 69), sf::Color(58, 137, 85)};
+        sf::Vector2u health_bar_margins(50, 50);
+        sf::Vector2f health_bar_offset(9 * GUI_SCALE_FACTOR, 4 * GUI_SCALE_FACTOR);
+        std::vector<int> player_sides = {-1, 1};
+
+        Player player(
+                coordinates,
+                rotation,
+                PLAYER_DIMENSIONS,
+                sprites.players[index % sprites.players.size()],
+                tuning.player_mass,
+                velocity,
+                tuning.movement_speed,
+                tuning.rotation_speed,
+                tuning.bullet_speed,
+                sprites.trail,
+                sprites.bullet,
+                BULLET_DIMENSIONS,
+                index < player_controls.size() ? player_controls[index] : std::map<int, int>(),
+                tuning.health,
+                tuning.bullet_damage,
+                HEALTH_BAR_DIMENSIONS,
+                health_bar_color[index % health_bar_color.size()],
+                player_sides[index % player_sides.size()],
+                health_bar_margins,
+                health_bar_offset,
+                sprites.health_bar
+        );
+        player.set_masks(sprites.ship_mask, sprites.bullet_mask);
+        return player;
+    }
+
+    Planet create_planet(Vector coordinates, const WorldSprites& sprites, const Tuning& tuning) {
+        return Planet(coordinates, PLANET_DIMENSIONS.x / 2, sprites.planet, tuning.planet_mass);
+    }
+}
+
+// level must be below LEVEL_COUNT; the tools check it before getting here.
+LevelLayout level_layout(int level) {
+    std::vector<float> player_rotations = {0, 180};
+
+    std::vector<std::vector<sf::Vector2f>> all_player_coordinates = {
+            {
+                sf::Vector2f(100, 540),
+                sf::Vector2f(1820, 540)
+            },
+            {
+                sf::Vector2f(1220, 500),
+                sf::Vector2f(700, 500)
+            },
+            {
+                sf::Vector2f(200, 540),
+                sf::Vector2f(1720, 540)
+            }
+    };
+
+    std::vector<std::vector<sf::Vector2f>> all_player_velocities = {
+            {
+                sf::Vector2f(0, 10),
+                sf::Vector2f(0, -10)
+            },
+            {
+                sf::Vector2f(0, 10),
+                sf::Vector2f(0, -10)
+            },
+            {
+                sf::Vector2f(0, 10),
+                sf::Vector2f(0, -10)
+            }
+    };
+
+    std::vector<std::vector<sf::Vector2f>> all_planet_coordinates = {
+            {
+                sf::Vector2f(376, 540),
+                sf::Vector2f(960, 540),
+                sf::Vector2f(1544, 540)
+            },
+            {
+                sf::Vector2f(960, 540)
+            },
+            {
+                sf::Vector2f(960, 540),
+                sf::Vector2f(960, 540),
+                sf::Vector2f(960, 540)
+            }
+    };
+
+    std::vector<std::vector<Rail>> all_planet_rails = {
+            {},
+            {},
+            {
+                {-1, 0, 0, 0},
+                {0, 350, 40, 270},
+                {1, 130, 8, 0}
+            }
+    };
+
+    sf::Vector2f world_offset = sf::Vector2f(WORLD_DIMENSIONS - DISPLAY_DIMENSIONS) / 2.f;
+
+    LevelLayout layout;
+    layout.player_rotations = player_rotations;
+    layout.player_velocities = all_player_velocities[level];
+    layout.planet_rails = all_planet_rails[level];
+    for (sf::Vector2f coordinates : all_player_coordinates[level]) {
+        layout.player_coordinates.push_back(coordinates + world_offset);
+    }
+    for (sf::Vector2f coordinates : all_planet_coordinates[level]) {
+        layout.planet_coordinates.push_back(coordinates + world_offset);
+    }
+    return layout;
+}
+
+World create_world(int level, const WorldSprites& sprites, const Tuning& tuning) {
+    return create_world(level_layout(level), sprites, tuning);
+}
+
+// Every player carries its own copy of the sprite maps, which is most of what a world costs.
+World create_world(const LevelLayout& layout, const WorldSprites& sprites, const Tuning& tuning) {
+    MemoryScope scope(MemoryTags::ASSETS);
+    std::vector<Player> players;
+    std::vector<Planet> planets;
+
+    for (int i = 0; i < layout.player_coordinates.size(); i++) {
+        players.push_back(create_player(i, Vector(layout.player_coordinates[i]), layout.player_rotations[i],
+                                        Vector(layout.player_velocities[i]), sprites, tuning));
+    }
+
+    for (sf::Vector2f coordinates : layout.planet_coordinates) {
+        planets.push_back(create_planet(Vector(coordinates), sprites, tuning));
+    }
+
+    std::vector<Orbit> orbits;
+    for (int i = 0; i < planets.size(); i++) {
+        Orbit orbit(planets[i].get_coordinates());
+        if (i < layout.planet_rails.size()) {
+            const Rail& rail = layout.planet_rails[i];
+            if (rail.parent >= 0) {
+                orbit = orbits[rail.parent];
+            }
+            if (rail.radius > 0) {
+                orbit = orbit.around(rail.radius, rail.radius, (int) (rail.period * FPS), rail.phase);
+                planets[i].set_orbit(orbit);
+            }
+        }
+        orbits.push_back(orbit);
+    }
+
+    for (Planet& planet : planets) {
+        planet.update_transform();
+    }
+
+    return World(players, planets, sf::FloatRect(0, 0, WORLD_DIMENSIONS.x, WORLD_DIMENSIONS.y));
+}
+
+World create_scenario(int player_count, int planet_count, const WorldSprites& sprites, const Tuning& tuning) {
+    MemoryScope scope(MemoryTags::ASSETS);
+    std::vector<Player> players;
+    std::vector<Planet> planets;
+    sf::Vector2f center = sf::Vector2f(WORLD_DIMENSIONS) / 2.f;
+
+    int columns = (int) std::ceil(std::sqrt((float) planet_count));
+    float spacing = 300;
+    for (int i = 0; i < planet_count; i++) {
+        sf::Vector2f offset((i % columns - (columns - 1) / 2.f) * spacing, (i / columns - (columns - 1) / 2.f) * spacing);
+        planets.push_back(create_planet(Vector(center + offset), sprites, tuning));
+    }
+
+    // Ships circle the grid well clear of its corners, at the speed of a circular orbit around its total
+    // mass, so they stay alive for the whole run instead of falling into it.
+    float radius = columns * spacing + 600;
+    float speed = std::sqrt((float) planet_count * tuning.planet_mass * tuning.player_mass * GRAVITY / radius);
+    for (int i = 0; i < player_count; i++) {
+        Scalar angle = 360.f * i / player_count;
+        Vector coordinates = Vector(center) + find_velocity(angle, radius);
+        players.push_back(create_player(i, coordinates, angle + 90, find_velocity(angle + 90, speed), sprites, tuning));
+    }
+
+    return World(players, planets, sf::FloatRect(0, 0, WORLD_DIMENSIONS.x, WORLD_DIMENSIONS.y));
+}
@@ -0,0 +1,59 @@
+#ifndef GRAVITYARENA_LEVEL_H
+#define GRAVITYARENA_LEVEL_H
+
+#include <SFML/Graphics.hpp>
+#include "spritesheet.h"
+#include "world.h"
+#include <memory>
+
+struct WorldSprites {
+    std::vector<std::map<int, SpriteVector>> players;
+    sf::Sprite trail;
+    sf::Sprite bullet;
+    sf::Sprite health_bar;
+    sf::Sprite planet;
+    std::shared_ptr<const RotatedMasks> ship_mask;
+    std::shared_ptr<const RotatedMasks> bullet_mask;
+};
+
+struct Tuning {
+    int planet_mass = 3000;
+    int player_mass = 10;
+    float movement_speed = 1.5f / FPS;
+    float rotation_speed = 300.f / FPS;
+    float bullet_speed = 500.f / FPS;
+    int health = 100;
+    int bullet_damage = 10;
+};
+
+// A rail with no radius leaves the planet where the level puts it; parent is the index of the
+// planet it circles, or -1 to circle its own coordinates. Periods are in seconds.
+struct Rail {
+    int parent;
+    float radius;
+    float period;
+    float phase;
+};
+
+// Where ships and planets start, in world coordinates. Written by hand for the numbered levels and
+// by LevelGenerator for the rest.
+struct LevelLayout {
+    std::vector<sf::Vector2f> player_coordinates;
+    std::vector<float> player_rotations;
+    std::vector<sf::Vector2f> player_velocities;
+    std::vector<sf::Vector2f> planet_coordinates;
+    std::vector<Rail> planet_rails;
+    std::uint32_t seed = 0;
+};
+
+WorldSprites load_sprites(SpriteSheet& ship_sheet, SpriteSheet& planet_sheet, SpriteSheet& misc_sheet);
+WorldSprites headless_sprites();
+WorldSprites headless_sprites(const sf::Image& ship_sheet, const sf::Image& misc_sheet);
+const int LEVEL_COUNT = 3;
+
+LevelLayout level_layout(int level);
+World create_world(int level, const WorldSprites& sprites, const Tuning& tuning = Tuning());
+World create_world(const LevelLayout& layout, const WorldSprites& sprites, const Tuning& tuning = Tuning());
+World create_scenario(int player_count, int planet_count, const WorldSprites& sprites, const Tuning& tuning = Tuning());
+
+#endif //GRAVITYARENA_LEVEL_H
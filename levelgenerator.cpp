@@ -0,0 +1,193 @@
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <random>
+#include <thread>
+#include "levelgenerator.h"
+#include "game.h"
+
+namespace {
+    const int JOB_CHUNK = 16;
+    const int MIN_BATCH = 256;
+    const int MAX_BATCH = 1 << 16;
+    const int PLACEMENT_ATTEMPTS = 64;
+
+    const char* REJECTION_NAMES[] = {"valid", "spawn_overlap", "weak_field", "strong_field", "crash", "escape"};
+
+    // Candidates are numbered, and each number gets its own well mixed seed so neighbours do not
+    // produce similar layouts.
+    std::uint32_t candidate_seed(std::uint32_t seed, std::uint32_t index) {
+        std::uint64_t x = ((std::uint64_t) seed << 32 | index) + 0x9e3779b97f4a7c15ULL;
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+        return (std::uint32_t) (x ^ (x >> 31));
+    }
+
+    float length(sf::Vector2f vector) {
+        return std::sqrt(vector.x * vector.x + vector.y * vector.y);
+    }
+}
+
+const char* LevelRejections::name(int reason) {
+    return REJECTION_NAMES[reason];
+}
+
+LevelGenerator::LevelGenerator(LevelSettings settings, Tuning tuning, unsigned thread_count) :
+        settings(settings),
+        tuning(tuning),
+        thread_count(std::max(1u, thread_count)),
+        sprites(headless_sprites())
+{}
+
+// Works through candidates in batches sized from the acceptance rate so far and keeps the first count
+// valid ones in candidate order. Returns fewer, possibly none, when the candidate budget runs out.
+std::vector<LevelLayout> LevelGenerator::generate(std::uint32_t seed, int count) {
+    std::vector<LevelLayout> layouts;
+    std::uint64_t accepted = 0;
+    std::uint64_t examined = 0;
+    std::uint32_t next_candidate = 0;
+    while ((int) layouts.size() < count && examined < (std::uint64_t) settings.max_candidates) {
+        double acceptance = examined ? std::max(0.01, (double) accepted / examined) : 0.5;
+        int batch = (int) std::min<double>(MAX_BATCH, std::max<double>(MIN_BATCH,
+                                                                        (count - layouts.size()) / acceptance * 1.2));
+        batch = (int) std::min<std::uint64_t>(batch, settings.max_candidates - examined);
+        std::vector<LevelLayout> proposed(batch);
+        std::vector<int> results(batch);
+        std::atomic<int> next_job(0);
+        auto work = [&]() {
+            for (int first = next_job.fetch_add(JOB_CHUNK); first < batch; first = next_job.fetch_add(JOB_CHUNK)) {
+                for (int job = first; job < std::min(first + JOB_CHUNK, batch); job++) {
+                    proposed[job] = propose(candidate_seed(seed, next_candidate + (std::uint32_t) job));
+                    results[job] = validate(proposed[job]);
+                }
+            }
+        };
+        std::vector<std::thread> workers;
+        for (unsigned t = 1; t < thread_count; t++) {
+            workers.push_back(std::thread(work));
+        }
+        work();
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+
+        for (int job = 0; job < batch; job++) {
+            rejections[results[job]] += 1;
+            accepted += results[job] == LevelRejections::NONE;
+            if (results[job] == LevelRejections::NONE && (int) layouts.size() < count) {
+                layouts.push_back(std::move(proposed[job]));
+            }
+        }
+        examined += batch;
+        candidates += batch;
+        next_candidate += (std::uint32_t) batch;
+    }
+    return layouts;
+}
+
+// An odd planet count puts one planet in the centre. Ships start in an orbit around the pull at
+// their spawn, turned towards the centre.
+LevelLayout LevelGenerator::propose(std::uint32_t seed) const {
+    std::mt19937 random(seed);
+    sf::Vector2f center = sf::Vector2f(WORLD_DIMENSIONS) / 2.f;
+    sf::Vector2f half = settings.dimensions / 2.f - sf::Vector2f(settings.edge_margin, settings.edge_margin);
+    std::uniform_real_distribution<float> x(-half.x, half.x);
+    std::uniform_real_distribution<float> y(-half.y, half.y);
+    std::uniform_real_distribution<float> jitter(-1, 1);
+
+    LevelLayout layout;
+    layout.seed = seed;
+    float area = settings.dimensions.x * settings.dimensions.y / 1e6f;
+    int planet_count = std::max(1, (int) std::lround(settings.density * area + jitter(random)));
+    if (planet_count % 2) {
+        layout.planet_coordinates.push_back(center);
+    }
+    for (int attempt = 0; attempt < PLACEMENT_ATTEMPTS && layout.planet_coordinates.size() < planet_count; attempt++) {
+        sf::Vector2f offset(x(random), y(random));
+        bool clear = length(offset) * 2 >= settings.planet_spacing;
+        for (sf::Vector2f planet : layout.planet_coordinates) {
+            clear = clear && length(center + offset - planet) >= settings.planet_spacing
+                    && length(center - offset - planet) >= settings.planet_spacing;
+        }
+        if (clear) {
+            layout.planet_coordinates.push_back(center + offset);
+            layout.planet_coordinates.push_back(center - offset);
+        }
+    }
+
+    sf::Vector2f spawn = center + sf::Vector2f(x(random), y(random));
+    sf::Vector2f pull;
+    float nearest = -1;
+    for (sf::Vector2f planet : layout.planet_coordinates) {
+        sf::Vector2f direction = planet - spawn;
+        float distance = std::max(length(direction), 1.f);
+        pull += direction / distance * (float) (tuning.planet_mass * tuning.player_mass * GRAVITY) / (distance * distance);
+        nearest = nearest < 0 ? distance : std::min(nearest, distance);
+    }
+    float strength = std::max(length(pull), 1e-6f);
+    float speed = std::sqrt(strength * nearest);
+    sf::Vector2f velocity = sf::Vector2f(-pull.y, pull.x) / strength * speed * (random() % 2 ? 1.f : -1.f);
+    float rotation = to_degrees(std::atan2(center.y - spawn.y, center.x - spawn.x));
+
+    layout.player_coordinates = {spawn, center * 2.f - spawn};
+    layout.player_velocities = {velocity, -velocity};
+    layout.player_rotations = {rotation, rotation + 180};
+    return layout;
+}
+
+// Builds the world the layout describes and lets it run one tick with the trail stretched, so the
+// predictor judges the drift with exactly the physics the match will use.
+int LevelGenerator::validate(const LevelLayout& layout) const {
+    World world = create_world(layout, sprites, tuning);
+    std::vector<Player>& players = world.get_players();
+    const std::vector<Planet>& planets = world.get_planets();
+
+    for (const Player& player : players) {
+        for (const Planet& planet : planets) {
+            Circle circle = planet.shape();
+            circle.radius += Scalar(settings.spawn_clearance);
+            if (player.hits(circle)) {
+                return LevelRejections::SPAWN_OVERLAP;
+            }
+        }
+    }
+
+    for (const Player& player : players) {
+        Player probe = player;
+        for (const Planet& planet : planets) {
+            probe.process_gravity(planet);
+        }
+        float pull = (float) find_distance(probe.get_velocity(), player.get_velocity());
+        if (pull < settings.min_pull) {
+            return LevelRejections::WEAK_FIELD;
+        }
+        if (pull > settings.max_pull) {
+            return LevelRejections::STRONG_FIELD;
+        }
+    }
+
+    for (Player& player : players) {
+        player.set_trail_length(settings.survival_ticks - 1);
+    }
+    world.tick();
+    sf::FloatRect bounds(0, 0, WORLD_DIMENSIONS.x, WORLD_DIMENSIONS.y);
+    for (const Player& player : players) {
+        if (!player.is_alive() || player.get_trail().size() < settings.survival_ticks - 1) {
+            return LevelRejections::CRASH;
+        }
+        for (Vector point : player.get_trail()) {
+            if (!bounds.contains(sf::Vector2f(point))) {
+                return LevelRejections::ESCAPE;
+            }
+        }
+    }
+    return LevelRejections::NONE;
+}
+
+std::uint64_t LevelGenerator::get_candidates() const {
+    return candidates;
+}
+
+std::uint64_t LevelGenerator::get_rejections(int reason) const {
+    return rejections[reason];
+}
@@ -0,0 +1,57 @@
+#ifndef GRAVITYARENA_LEVELGENERATOR_H
+#define GRAVITYARENA_LEVELGENERATOR_H
+
+#include <SFML/Graphics.hpp>
+#include <cstdint>
+#include "level.h"
+
+namespace LevelRejections {
+    enum Enum {
+        NONE,
+        SPAWN_OVERLAP,
+        WEAK_FIELD,
+        STRONG_FIELD,
+        CRASH,
+        ESCAPE,
+        COUNT
+    };
+
+    const char* name(int reason);
+}
+
+// Pulls are the speed a ship gains per tick at its spawn. Ships must drift for survival_ticks
+// without hitting a planet or leaving the world. generate() gives up after max_candidates.
+struct LevelSettings {
+    sf::Vector2f dimensions = sf::Vector2f(DISPLAY_DIMENSIONS);
+    float density = 1.5f;
+    float edge_margin = 150;
+    float planet_spacing = 250;
+    float spawn_clearance = 60;
+    float min_pull = 0.05f;
+    float max_pull = 1;
+    int survival_ticks = FPS * 10;
+    int max_candidates = 1 << 20;
+};
+
+// Proposes planet fields mirrored through the centre of the world, with mirrored spawns so both ships
+// face the same arena, and keeps the ones that pass validate(). Density is planets per million square
+// pixels of dimensions. Candidates are validated on thread_count threads, but which layouts come back
+// depends only on the seed.
+class LevelGenerator {
+public:
+    LevelGenerator(LevelSettings settings, Tuning tuning = Tuning(), unsigned thread_count = 1);
+    std::vector<LevelLayout> generate(std::uint32_t seed, int count);
+    LevelLayout propose(std::uint32_t seed) const;
+    int validate(const LevelLayout& layout) const;
+    std::uint64_t get_candidates() const;
+    std::uint64_t get_rejections(int reason) const;
+private:
+    LevelSettings settings;
+    Tuning tuning;
+    unsigned thread_count;
+    WorldSprites sprites;
+    std::uint64_t candidates = 0;
+    std::uint64_t rejections[LevelRejections::COUNT] = {};
+};
+
+#endif //GRAVITYARENA_LEVELGENERATOR_H
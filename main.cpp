@@ -1,270 +1,318 @@
 #include <SFML/Graphics.hpp>
+#include <cstdlib>
+#include <memory>
 #include "spritesheet.h"
 #include "game.h"
 #include "classes.h"
+#include "level.h"
+#include "levelgenerator.h"
+#include "camera.h"
+#include "spatialgrid.h"
+#include "staticlayer.h"
+#include "renderscaler.h"
+#include "particles.h"
+#include "metrics.h"
+#include "simulation.h"
+#include "latency.h"
+#include "relay.h"
+#include "audio.h"
+#include "allocations.h"
+#include "memoryoverlay.h"
+
+int main(int argc, char* argv[]) {
+    bool low_latency = false;
+    bool relay_enabled = false;
+    bool null_audio = false;
+    int level = 1;
+    long seed = -1;
+    for (int i = 1; i < argc; i++) {
+        if (std::string(argv[i]) == "--low-latency") {
+            low_latency = true;
+        } else if (std::string(argv[i]) == "--relay") {
+            relay_enabled = true;
+        } else if (std::string(argv[i]) == "--null-audio") {
+            null_audio = true;
+        } else if (std::string(argv[i]) == "--level" && i + 1 < argc) {
+            level = std::atoi(argv[++i]);
+        } else if (std::string(argv[i]) == "--seed" && i + 1 < argc) {
+            seed = std::atol(argv[++i]);
+        }
+    }
+    if (level < 0 || level >= LEVEL_COUNT) {
+        std::cerr << "unknown level " << level << ", levels are 0 to " << LEVEL_COUNT - 1 << std::endl;
+        return 2;
+    }
 
-void print_nums(sf::Vector2f vector) {
-    printf("%f, %f \n", vector.x, vector.y);
-}
-
-void print_nums(sf::Vector2i vector) {
-    printf("%i, %i \n", vector.x, vector.y);
-}
-
-void print_nums(sf::Vector2u vector) {
-    printf("%u, %u \n", vector.x, vector.y);
-}
-
-float to_radians(float degrees) {
-    return degrees * (PI / 180);
-}
-
-float to_degrees(float radians) {
-    return radians * (180 / PI);
-}
-
-float find_distance(sf::Vector2f coordinates_1, sf::Vector2f coordinates_2) {
-    return (float) std::sqrt(
-            std::pow(coordinates_1.x - coordinates_2.x, 2) + std::pow(coordinates_1.y - coordinates_2.y, 2));
-}
-
-sf::Vector2f find_velocity(float angle, float force) {
-    sf::Vector2f velocity;
-    velocity.x = std::cos(to_radians(angle)) * force;
-    velocity.y = std::sin(to_radians(angle)) * force;
-    return velocity;
-}
+    // Setup is charged to the subsystem being built; code that allocates while the game runs tags itself.
+    Allocations::current_tag() = MemoryTags::ASSETS;
+    sf::Clock startup_clock;
+    AssetManager assets;
+    assets.add("ship_sheet.png");
+    assets.add("planet_sheet.png");
+    assets.add("misc_sheet.png");
+    assets.start();
 
-int main() {
-    const RectHitBox DISPLAY_HITBOX(DISPLAY_DIMENSIONS);
+    const sf::FloatRect WORLD_BOUNDS(0, 0, WORLD_DIMENSIONS.x, WORLD_DIMENSIONS.y);
     sf::RenderWindow window(sf::VideoMode(DISPLAY_DIMENSIONS.x, DISPLAY_DIMENSIONS.y),
                             "Gravity Arena", sf::Style::Fullscreen);
-    window.setFramerateLimit(FPS);
+    window.setFramerateLimit(low_latency ? 0 : FPS);
     window.setKeyRepeatEnabled(false);
 
-    SpriteSheet ship_sheet("ship_sheet.png", SCALE_FACTOR);
-    SpriteSheet planet_sheet("planet_sheet.png", SCALE_FACTOR);
-    SpriteSheet misc_sheet("misc_sheet.png", SCALE_FACTOR);
-
-    std::vector<Player> players;
-    std::vector<Planet> planets;
-
-    {
-        sf::Vector2u player_dimensions(25, 13);
-        std::vector<std::map<int, SpriteVector>> player_sprites;
-        std::map<int, SpriteVector> sprites;
-        for (int i = 0; i < 2; i++) {
-            sprites[PlayerSpriteTypes::IDLE] = ship_sheet.get_sprites(player_dimensions);
-            sprites[PlayerSpriteTypes::ACCELERATING] = ship_sheet.get_custom_sprites(player_dimensions, 4);
-            sprites[PlayerSpriteTypes::EXPLODING] = ship_sheet.get_custom_sprites(sf::Vector2u(31, 19), 4);
-            player_sprites.push_back(sprites);
+    assets.wait();
+    SpriteSheet ship_sheet(assets, "ship_sheet.png", SCALE_FACTOR);
+    SpriteSheet planet_sheet(assets, "planet_sheet.png", SCALE_FACTOR);
+    SpriteSheet misc_sheet(assets, "misc_sheet.png", SCALE_FACTOR);
+    Allocations::add_external(MemoryTags::TEXTURES, (std::int64_t) (ship_sheet.get_texture_bytes()
+            + planet_sheet.get_texture_bytes() + misc_sheet.get_texture_bytes()));
+
+    Allocations::current_tag() = MemoryTags::HUD;
+    Hud hud;
+    MemoryOverlay memory_overlay(MEMORY_OVERLAY_COORDINATES, MEMORY_OVERLAY_ROW);
+    SpatialGrid planet_grid(WORLD_DIMENSIONS, WORLD_CELL_SIZE);
+    Camera camera(sf::Vector2f(DISPLAY_DIMENSIONS), WORLD_BOUNDS, CAMERA_MIN_ZOOM, CAMERA_MAX_ZOOM, CAMERA_MARGIN);
+    std::vector<int> visible_planets;
+    StaticLayer world_layer;
+    StaticLayer hud_layer;
+    if (world_layer.create(WORLD_DIMENSIONS)) {
+        Allocations::add_external(MemoryTags::TEXTURES, (std::int64_t) WORLD_DIMENSIONS.x * WORLD_DIMENSIONS.y * 4);
+    }
+    if (hud_layer.create(DISPLAY_DIMENSIONS)) {
+        Allocations::add_external(MemoryTags::TEXTURES, (std::int64_t) DISPLAY_DIMENSIONS.x * DISPLAY_DIMENSIONS.y * 4);
+    }
+    RenderScaler render_scaler(DISPLAY_DIMENSIONS, RENDER_SCALE_MIN, RENDER_SCALE_MAX,
+                               sf::seconds(RENDER_FRAME_BUDGET / FPS));
+    render_scaler.create();
+    Allocations::current_tag() = MemoryTags::PARTICLES;
+    ParticleSystem particles(PARTICLE_CAPACITY, PARTICLE_SIZE);
+    Allocations::current_tag() = MemoryTags::AUDIO;
+    std::unique_ptr<AudioDevice> audio_device(null_audio ? (AudioDevice*) new NullAudioDevice
+                                                         : new SfmlAudioDevice(AUDIO_VOICES));
+    AudioSystem audio(*audio_device, AUDIO_VOICES, AUDIO_SAMPLE_RATE);
+    audio.play_music(MUSIC_PATH, MUSIC_VOLUME);
+    sf::Clock frame_clock;
+    sf::Clock latency_clock;
+    LatencyTracker latency(LATENCY_SAMPLES);
+    sf::Time frame_time = sf::seconds(1.f / FPS);
+    sf::Time next_frame;
+    sf::Time next_tick;
+    sf::Time work_estimate;
+
+    Allocations::current_tag() = MemoryTags::NETWORK;
+    MetricsExporter metrics(METRICS_PORT, METRICS_DUMP_PATH, sf::seconds(METRICS_DUMP_INTERVAL));
+    metrics.start();
+
+    assets.report(std::cout);
+    std::cout << "startup: " << startup_clock.getElapsedTime().asMilliseconds() << " ms" << std::endl;
+
+    Allocations::current_tag() = MemoryTags::ASSETS;
+    WorldSprites sprites = load_sprites(ship_sheet, planet_sheet, misc_sheet);
+    LevelLayout layout = level_layout(level);
+    if (seed >= 0) {
+        std::vector<LevelLayout> generated = LevelGenerator(LevelSettings()).generate((std::uint32_t) seed, 1);
+        if (generated.empty()) {
+            std::cerr << "no valid level for seed " << seed << ", playing level " << level << std::endl;
+        } else {
+            layout = generated[0];
         }
-        sf::Vector2u trail_dimensions(4, 4);
-        sf::Sprite trail_sprite = misc_sheet.get_sprites(trail_dimensions)[0];
-        sf::Vector2u bullet_dimensions(8, 3);
-        sf::Sprite bullet_sprite = misc_sheet.get_sprites(bullet_dimensions)[0];
-        sf::Vector2u health_bar_dimensions(128, 19);
-        sf::Sprite health_bar_sprite = misc_sheet.get_sprites(health_bar_dimensions, 0, GUI_SCALE_FACTOR)[0];
-
-        std::vector<std::map<int, int>> player_controls;
-        std::map<int, int> controls;
-        controls[sf::Keyboard::W] = PlayerActions::ACCELERATE;
-        controls[sf::Keyboard::D] = PlayerActions::ROTATE_RIGHT;
-        controls[sf::Keyboard::A] = PlayerActions::ROTATE_LEFT;
-        controls[sf::Keyboard::Q] = PlayerActions::SHOOT;
-        player_controls.push_back(controls);
-        controls.clear();
-        controls[sf::Keyboard::Up] = PlayerActions::ACCELERATE;
-        controls[sf::Keyboard::Right] = PlayerActions::ROTATE_RIGHT;
-        controls[sf::Keyboard::Left] = PlayerActions::ROTATE_LEFT;
-        controls[sf::Keyboard::Slash] = PlayerActions::SHOOT;
-        player_controls.push_back(controls);
-        controls.clear();
-
-        std::vector<int> player_rotations = {0, 180};
-        int player_mass = 10;
-        float player_movement_speed = 1.5f / FPS;
-        float player_rotation_speed = 300.f / FPS;
-        float player_bullet_speed = 500.f / FPS;
-        int player_health = 100;
-        int player_bullet_damage = 10;
-        std::vector<sf::Color> health_bar_color = {sf::Color(162, 69, 69), sf::Color(58, 137, 85)};
-        sf::Vector2u health_bar_margins(50, 50);
-        sf::Vector2f health_bar_offset(9 * GUI_SCALE_FACTOR, 4 * GUI_SCALE_FACTOR);
-        std::vector<int> player_sides = {-1, 1};
-
-        sf::Vector2u planet_dimensions(84, 84);
-        sf::Sprite planet_sprite = planet_sheet.get_sprites(planet_dimensions)[0];
-
-        int planet_mass = 3000;
-
-
-        std::vector<std::vector<sf::Vector2f>> all_player_coordinates = {
-                {
-                    sf::Vector2f(100, 540),
-                    sf::Vector2f(1820, 540)
-                },
-                {
-                    sf::Vector2f(1220, 500),
-                    sf::Vector2f(700, 500)
-                }
-        };
-
-        std::vector<std::vector<sf::Vector2f>> all_player_velocities = {
-                {
-                    sf::Vector2f(0, 10),
-                    sf::Vector2f(0, -10)
-                },
-                {
-                    sf::Vector2f(0, 10),
-                    sf::Vector2f(0, -10)
-                }
-        };
-
-        std::vector<std::vector<sf::Vector2f>> all_planet_coordinates = {
-                {
-                    sf::Vector2f(376, 540),
-                    sf::Vector2f(960, 540),
-                    sf::Vector2f(1544, 540)
-                },
-                {
-                    sf::Vector2f(960, 540)
-                }
-        };
+    }
+    World world = create_world(layout, sprites);
+    world.set_bullet_gravity(BULLET_GRAVITY);
+    std::vector<Player> players = world.get_players();
+    std::vector<Planet> planets = world.get_planets();
+    // The relay is declared first so it outlives the simulation thread that publishes to it.
+    Allocations::current_tag() = MemoryTags::NETWORK;
+    SpectatorRelay relay(RELAY_PORT, RELAY_MAX_QUEUED_FRAMES);
+    Allocations::current_tag() = MemoryTags::ASSETS;
+    Simulation simulation(std::move(world), sf::seconds(1.f / FPS));
+    if (relay_enabled && relay.start()) {
+        simulation.attach_relay(relay);
+    }
+    int rendered_tick = simulation.get_snapshot().tick;
 
-        int level = 1;
-        std::vector<sf::Vector2f> player_coordinates = all_player_coordinates[level];
-        std::vector<sf::Vector2f> player_velocities = all_player_velocities[level];
-        std::vector<sf::Vector2f> planet_coordinates = all_planet_coordinates[level];
+    for (Player& player : players) {
+        player.attach_hud(hud);
+        player.attach_particles(particles);
+        player.attach_audio(audio);
+    }
 
-        for (int i = 0; i < all_player_coordinates.size(); i++) {
-            players.push_back(
-                    Player(
-                            player_coordinates[i],
-                            player_rotations[i],
-                            player_dimensions,
-                            player_sprites[i],
-                            player_mass,
-                            player_velocities[i],
-                            player_movement_speed,
-                            player_rotation_speed,
-                            player_bullet_speed,
-                            trail_sprite,
-                            bullet_sprite,
-                            bullet_dimensions,
-                            player_controls[i],
-                            player_health,
-                            player_bullet_damage,
-                            health_bar_dimensions,
-                            health_bar_color[i],
-                            player_sides[i],
-                            health_bar_margins,
-                            health_bar_offset,
-                            health_bar_sprite
-                    )
-            );
+    // Orbiting planets are left out of the cached layer and the grid and drawn every frame instead.
+    bool orbiting_planets = false;
+    for (int i = 0; i < planets.size(); i++) {
+        if (planets[i].is_orbiting()) {
+            orbiting_planets = true;
+        } else {
+            planet_grid.insert(i, planets[i].bounds());
         }
+        particles.add_attractor(sf::Vector2f(planets[i].get_coordinates()), (float) planets[i].shape().radius,
+                                (float) planets[i].get_mass());
+    }
 
-        for (sf::Vector2f coordinates : planet_coordinates) {
-            planets.push_back(
-                    Planet(
-                            coordinates,
-                            planet_dimensions.x / 2,
-                            planet_sprite,
-                            planet_mass
-                    )
-            );
-        }
+    Allocations::current_tag() = MemoryTags::OTHER;
 
-        for (Planet& planet : planets) {
-            planet.update_transform();
-        }
+    if (!low_latency) {
+        simulation.start();
     }
 
-
     while (window.isOpen()) {
+        if (low_latency) {
+            // Sleep first and wake just in time to poll, simulate and present, so the frame shows the
+            // newest input instead of input that waited out the frame limiter.
+            sf::Time wake = next_frame - work_estimate - sf::seconds(LOW_LATENCY_MARGIN);
+            sf::Time now = latency_clock.getElapsedTime();
+            if (wake > now) {
+                sf::sleep(wake - now);
+            }
+        }
+        frame_clock.restart();
+        latency.begin_poll(latency_clock.getElapsedTime());
         sf::Event event;
         while (window.pollEvent(event)) {
+            if (event.type == sf::Event::KeyPressed && event.key.code == MEMORY_OVERLAY_KEY) {
+                memory_overlay.toggle();
+                continue;
+            }
             switch (event.type) {
                 case sf::Event::Closed:
                     window.close();
                     break;
 
+                case sf::Event::Resized:
+                    world_layer.invalidate();
+                    hud_layer.invalidate();
+                    break;
+
+                case sf::Event::MouseWheelScrolled:
+                    camera.zoom(event.mouseWheelScroll.delta);
+                    break;
+
                 case sf::Event::KeyPressed:
                 case sf::Event::KeyReleased:
-                    for (Player& player : players) {
-                        if (player.is_alive() && player.in_controls(event.key.code)) {
-                            bool pressed = event.type == sf::Event::KeyPressed;
-                            switch (player.action_type(event.key.code)) {
-                                case PlayerActions::ACCELERATE:
-                                    player.accelerate(pressed);
-                                    break;
-                                case PlayerActions::ROTATE_RIGHT:
-                                    player.turn(pressed, 1);
-                                    break;
-                                case PlayerActions::ROTATE_LEFT:
-                                    player.turn(pressed, -1);
-                                    break;
-                                case PlayerActions::SHOOT:
-                                    player.shoot(pressed);
-                                    break;
-                            }
-                        }
-                    }
+                    simulation.send_key(event.key.code, event.type == sf::Event::KeyPressed, latency.record());
                     break;
             }
         }
 
-        for (auto it_player = players.begin(); it_player != players.end(); ++it_player) {
-            if (it_player->is_active()) {
-                if (it_player->is_alive()) {
-                    it_player->accelerate();
-                    it_player->turn();
-                    it_player->shoot();
-                    it_player->update_gravity(std::vector<MassThing>(planets.begin(), planets.end()));
-                    it_player->update_coordinates();
-
-                    for (Planet& planet : planets) {
-                        if (it_player->collided(planet)) {
-                            it_player->planet_collision();
-                        }
-                    }
+        if (low_latency) {
+            // Step as many ticks as real time has advanced, so an overrun frame does not slow the game down.
+            // Like Simulation::work, a long stall resumes at normal speed instead of racing to catch up.
+            sf::Time now = latency_clock.getElapsedTime();
+            if (now - next_tick > frame_time * 4.f) {
+                next_tick = now;
+            }
+            while (next_tick <= now) {
+                simulation.step();
+                next_tick += frame_time;
+            }
+        }
+        if (simulation.receive()) {
+            const WorldSnapshot& snapshot = simulation.get_snapshot();
+            latency.reflect(snapshot.input_sequence);
+            for (int i = 0; i < players.size(); i++) {
+                players[i].apply_snapshot(snapshot.players[i]);
+            }
+            if (orbiting_planets) {
+                particles.clear_attractors();
+                for (int i = 0; i < planets.size(); i++) {
+                    planets[i].set_coordinates(snapshot.planets[i]);
+                    planets[i].update_transform();
+                    particles.add_attractor(sf::Vector2f(planets[i].get_coordinates()),
+                                            (float) planets[i].shape().radius, (float) planets[i].get_mass());
+                }
+            }
+            for (int i = rendered_tick; i < snapshot.tick && i < rendered_tick + MAX_PARTICLE_STEPS; i++) {
+                particles.update();
+            }
+            rendered_tick = snapshot.tick;
+        }
+        audio.update(latency_clock.getElapsedTime());
 
-                    it_player->update_bullets(DISPLAY_HITBOX);
-                    it_player->bullet_collision(players, planets);
-                    it_player->update_trail(planets);
-                } else {
-                    if (it_player->is_moving()) {
-                        it_player->update_gravity(std::vector<MassThing>(planets.begin(), planets.end()));
-                        it_player->update_coordinates();
-                    }
-                    if (it_player->update_sprites(false)) {
-                        it_player->end();
-                    }
+        if (world_layer.is_available() && !world_layer.is_valid()) {
+            sf::RenderTarget& target = world_layer.begin(BACKGROUND_COLOR);
+            for (Planet& planet : planets) {
+                if (!planet.is_orbiting()) {
+                    planet.display(target);
                 }
             }
+            world_layer.end();
+        }
+        if (hud_layer.is_available() && !hud_layer.is_valid()) {
+            sf::RenderTarget& target = hud_layer.begin(sf::Color::Transparent);
+            for (Player& player : players) {
+                player.display_health_box(target);
+            }
+            hud_layer.end();
         }
 
-        window.clear(BACKGROUND_COLOR);
+        camera.follow(players);
+        sf::FloatRect visible_area = camera.visible_area();
+        sf::RenderTarget* world_target = &window;
+        if (render_scaler.is_available()) {
+            world_target = &render_scaler.begin(camera.get_view());
+        } else {
+            camera.apply(window);
+        }
 
-        for (Planet& planet : planets) {
-            planet.display(window);
+        if (world_layer.is_valid()) {
+            world_layer.display(*world_target);
+        } else {
+            world_target->clear(BACKGROUND_COLOR);
+            visible_planets.clear();
+            planet_grid.query(visible_area, visible_planets);
+            for (int i : visible_planets) {
+                planets[i].display(*world_target);
+            }
+        }
+        if (orbiting_planets) {
+            for (Planet& planet : planets) {
+                if (planet.is_orbiting() && planet.is_visible(visible_area)) {
+                    planet.display(*world_target);
+                }
+            }
         }
 
+        particles.display(*world_target, visible_area);
         for (Player& player : players) {
             if (player.is_active()) {
                 if (player.is_alive()) {
-                    player.display_trail(window);
-                    player.display_bullets(window);
-                    player.display_health(window);
+                    player.display_trail(*world_target, visible_area);
+                    player.display_bullets(*world_target, visible_area);
                 }
                 player.update_transform();
-                player.display(window);
+                if (player.is_visible(visible_area)) {
+                    player.display(*world_target);
+                }
+            }
+        }
+
+        window.setView(window.getDefaultView());
+        if (render_scaler.is_available()) {
+            render_scaler.display(window);
+        }
+        hud.display(window);
+        memory_overlay.update();
+        memory_overlay.display(window);
+        if (hud_layer.is_valid()) {
+            hud_layer.display(window);
+        } else {
+            for (Player& player : players) {
+                player.display_health_box(window);
             }
-            player.display_health_box(window);
         }
 
+        render_scaler.update(frame_clock.getElapsedTime());
         window.display();
+        latency.present(latency_clock.getElapsedTime());
+        Metrics::add(MetricCounters::FRAMES);
+        Metrics::observe(MetricHistograms::FRAME_TIME, frame_clock.getElapsedTime().asSeconds());
+
+        if (low_latency) {
+            work_estimate = std::max(frame_clock.getElapsedTime(), work_estimate * LOW_LATENCY_DECAY);
+            next_frame = std::max(next_frame + frame_time, latency_clock.getElapsedTime());
+        }
     }
+    simulation.stop();
+    relay.stop();
+    latency.report(std::cout);
+    Allocations::report(std::cout);
     return 0;
 }
@@ -0,0 +1,74 @@
+#include <algorithm>
+#include "memoryoverlay.h"
+#include "metrics.h"
+
+namespace {
+    const sf::Color TAG_COLORS[MemoryTags::COUNT] = {
+            sf::Color(160, 160, 160),
+            sf::Color(230, 160, 40),
+            sf::Color(240, 220, 60),
+            sf::Color(220, 60, 60),
+            sf::Color(60, 200, 220),
+            sf::Color(60, 120, 230),
+            sf::Color(240, 120, 200),
+            sf::Color(120, 220, 90),
+            sf::Color(170, 100, 230),
+            sf::Color(40, 170, 120)
+    };
+    const sf::Color BACKGROUND(0, 0, 0, 160);
+    const sf::Uint8 PEAK_ALPHA = 90;
+}
+
+MemoryOverlay::MemoryOverlay(sf::Vector2f coordinates, sf::Vector2f row_dimensions) :
+        coordinates(coordinates),
+        row_dimensions(row_dimensions),
+        vertices(sf::Quads)
+{
+    MemoryScope scope(MemoryTags::HUD);
+    vertices.resize(MemoryTags::COUNT * 12);
+}
+
+void MemoryOverlay::update() {
+    MemoryUsage usages[MemoryTags::COUNT];
+    std::int64_t largest = 1;
+    for (int tag = 0; tag < MemoryTags::COUNT; tag++) {
+        usages[tag] = Allocations::usage(tag);
+        largest = std::max(largest, usages[tag].peak);
+        Metrics::set_memory(tag, usages[tag]);
+    }
+    if (!visible) {
+        return;
+    }
+    for (int tag = 0; tag < MemoryTags::COUNT; tag++) {
+        sf::Color peak = TAG_COLORS[tag];
+        peak.a = PEAK_ALPHA;
+        set_quad(tag * 3, row_dimensions.x, (float) tag, BACKGROUND);
+        set_quad(tag * 3 + 1, row_dimensions.x * usages[tag].peak / largest, (float) tag, peak);
+        set_quad(tag * 3 + 2, row_dimensions.x * std::max<std::int64_t>(usages[tag].current, 0) / largest,
+                 (float) tag, TAG_COLORS[tag]);
+    }
+}
+
+void MemoryOverlay::toggle() {
+    visible = !visible;
+}
+
+void MemoryOverlay::display(sf::RenderTarget& target) const {
+    if (visible) {
+        target.draw(vertices);
+    }
+}
+
+void MemoryOverlay::set_quad(int index, float width, float row, sf::Color color) {
+    float left = coordinates.x;
+    float top = coordinates.y + row * row_dimensions.y;
+    float height = row_dimensions.y - 2;
+    sf::Vertex* quad = &vertices[index * 4];
+    quad[0].position = sf::Vector2f(left, top);
+    quad[1].position = sf::Vector2f(left + width, top);
+    quad[2].position = sf::Vector2f(left + width, top + height);
+    quad[3].position = sf::Vector2f(left, top + height);
+    for (int i = 0; i < 4; i++) {
+        quad[i].color = color;
+    }
+}
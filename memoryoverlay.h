@@ -0,0 +1,24 @@
+#ifndef GRAVITYARENA_MEMORYOVERLAY_H
+#define GRAVITYARENA_MEMORYOVERLAY_H
+
+#include <SFML/Graphics.hpp>
+#include "allocations.h"
+
+// One row per memory tag, in MemoryTags order: the solid bar is the current footprint and the faint
+// one behind it the peak, both scaled to the largest peak. update() also feeds the numbers to Metrics.
+class MemoryOverlay {
+public:
+    MemoryOverlay(sf::Vector2f coordinates, sf::Vector2f row_dimensions);
+    void update();
+    void toggle();
+    void display(sf::RenderTarget& target) const;
+private:
+    sf::Vector2f coordinates;
+    sf::Vector2f row_dimensions;
+    bool visible = false;
+    sf::VertexArray vertices;
+
+    void set_quad(int index, float width, float row, sf::Color color);
+};
+
+#endif //GRAVITYARENA_MEMORYOVERLAY_H
@@ -0,0 +1,390 @@
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <vector>
+#ifdef __linux__
+#include <unistd.h>
+#endif
+#include "metrics.h"
+
+namespace {
+    const float BUCKETS[] = {0.005f, 0.01f, 0.02f, 0.0333f, 0.05f, 0.1f, 0.25f};
+    const int BUCKET_COUNT = sizeof(BUCKETS) / sizeof(BUCKETS[0]);
+    const sf::Int32 CLIENT_TIMEOUT_MS = 500;
+
+    const char* COUNTER_NAMES[] = {"ticks", "frames", "trail_steps", "collision_tests", "mask_tests",
+                                   "relay_bytes_sent", "relay_keyframes", "relay_resyncs"};
+    const char* GAUGE_NAMES[] = {"ticks_per_second", "simulation_thread_allocations", "resident_memory_bytes", "spectators"};
+    const char* HISTOGRAM_NAMES[] = {"frame_seconds", "input_latency_seconds"};
+
+    struct Shard {
+        std::atomic<std::uint64_t> counters[MetricCounters::COUNT];
+        std::atomic<std::uint64_t> buckets[MetricHistograms::COUNT][BUCKET_COUNT + 1];
+        std::atomic<std::uint64_t> microseconds[MetricHistograms::COUNT];
+
+        Shard() {
+            for (auto& counter : counters) {
+                counter = 0;
+            }
+            for (int i = 0; i < MetricHistograms::COUNT; i++) {
+                for (auto& bucket : buckets[i]) {
+                    bucket = 0;
+                }
+                microseconds[i] = 0;
+            }
+        }
+    };
+
+    // Shards outlive their threads so totals never go backwards. An exiting thread hands its shard back
+    // and the next new thread keeps counting in it, so short-lived workers do not grow the list.
+    std::mutex shards_mutex;
+    std::vector<std::unique_ptr<Shard>> shards;
+    std::vector<Shard*> free_shards;
+    thread_local Shard* local_shard = nullptr;
+
+    struct ShardLease {
+        Shard* shard = nullptr;
+
+        ~ShardLease() {
+            if (shard) {
+                std::lock_guard<std::mutex> lock(shards_mutex);
+                free_shards.push_back(shard);
+            }
+        }
+    };
+    thread_local ShardLease shard_lease;
+
+    std::atomic<std::int64_t> gauges[MetricGauges::COUNT];
+    std::atomic<std::int64_t> live_bullets[Metrics::MAX_PLAYERS];
+    std::atomic<std::int64_t> memory_current[MemoryTags::COUNT];
+    std::atomic<std::int64_t> memory_peak[MemoryTags::COUNT];
+    std::atomic<std::int64_t> memory_allocations[MemoryTags::COUNT];
+
+    Shard& shard() {
+        if (!local_shard) {
+            std::lock_guard<std::mutex> lock(shards_mutex);
+            if (free_shards.empty()) {
+                shards.emplace_back(new Shard());
+                local_shard = shards.back().get();
+            } else {
+                local_shard = free_shards.back();
+                free_shards.pop_back();
+            }
+            shard_lease.shard = local_shard;
+        }
+        return *local_shard;
+    }
+
+    void bump(std::atomic<std::uint64_t>& value, std::uint64_t amount) {
+        value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+    std::uint64_t sum_counter(int counter) {
+        std::lock_guard<std::mutex> lock(shards_mutex);
+        std::uint64_t total = 0;
+        for (const auto& shard : shards) {
+            total += shard->counters[counter].load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+    std::uint64_t sum_bucket(int histogram, int bucket) {
+        std::lock_guard<std::mutex> lock(shards_mutex);
+        std::uint64_t total = 0;
+        for (const auto& shard : shards) {
+            total += shard->buckets[histogram][bucket].load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+    double sum_seconds(int histogram) {
+        std::lock_guard<std::mutex> lock(shards_mutex);
+        std::uint64_t total = 0;
+        for (const auto& shard : shards) {
+            total += shard->microseconds[histogram].load(std::memory_order_relaxed);
+        }
+        return total / 1000000.0;
+    }
+
+    void write_bucket_bound(std::ostream& stream, int bucket) {
+        if (bucket < BUCKET_COUNT) {
+            stream << BUCKETS[bucket];
+        } else {
+            stream << "+Inf";
+        }
+    }
+
+    std::int64_t resident_memory() {
+#ifdef __linux__
+        long pages = 0;
+        long resident = 0;
+        FILE* file = std::fopen("/proc/self/statm", "r");
+        if (file) {
+            if (std::fscanf(file, "%ld %ld", &pages, &resident) != 2) {
+                resident = 0;
+            }
+            std::fclose(file);
+        }
+        return (std::int64_t) resident * sysconf(_SC_PAGESIZE);
+#else
+        return 0;
+#endif
+    }
+
+    sf::Clock rate_clock;
+    std::uint64_t rate_ticks = 0;
+}
+
+void Metrics::add(int counter, std::uint64_t amount) {
+    bump(shard().counters[counter], amount);
+}
+
+void Metrics::observe(int histogram, float seconds) {
+    Shard& local = shard();
+    int bucket = 0;
+    while (bucket < BUCKET_COUNT && seconds > BUCKETS[bucket]) {
+        bucket += 1;
+    }
+    bump(local.buckets[histogram][bucket], 1);
+    bump(local.microseconds[histogram], (std::uint64_t) (seconds * 1000000));
+}
+
+void Metrics::set(int gauge, std::int64_t value) {
+    gauges[gauge].store(value, std::memory_order_relaxed);
+}
+
+void Metrics::set_live_bullets(int player, int count) {
+    if (player < MAX_PLAYERS) {
+        live_bullets[player].store(count, std::memory_order_relaxed);
+    }
+}
+
+// Pushed by targets that track memory; the others report zeros.
+void Metrics::set_memory(int tag, const MemoryUsage& usage) {
+    memory_current[tag].store(usage.current, std::memory_order_relaxed);
+    memory_peak[tag].store(usage.peak, std::memory_order_relaxed);
+    memory_allocations[tag].store((std::int64_t) usage.allocations, std::memory_order_relaxed);
+}
+
+std::uint64_t Metrics::get(int counter) {
+    return sum_counter(counter);
+}
+
+// Derived gauges, refreshed by the exporter rather than the game loop.
+void Metrics::sample() {
+    std::uint64_t ticks = get(MetricCounters::TICKS);
+    float elapsed = rate_clock.restart().asSeconds();
+    if (elapsed > 0) {
+        set(MetricGauges::TICKS_PER_SECOND, (std::int64_t) ((ticks - rate_ticks) / elapsed));
+    }
+    rate_ticks = ticks;
+    set(MetricGauges::RESIDENT_MEMORY, resident_memory());
+}
+
+void Metrics::write_prometheus(std::ostream& stream) {
+    for (int i = 0; i < MetricCounters::COUNT; i++) {
+        stream << "# TYPE gravityarena_" << COUNTER_NAMES[i] << "_total counter\n"
+               << "gravityarena_" << COUNTER_NAMES[i] << "_total " << get(i) << "\n";
+    }
+    for (int i = 0; i < MetricGauges::COUNT; i++) {
+        stream << "# TYPE gravityarena_" << GAUGE_NAMES[i] << " gauge\n"
+               << "gravityarena_" << GAUGE_NAMES[i] << " " << gauges[i].load(std::memory_order_relaxed) << "\n";
+    }
+    stream << "# TYPE gravityarena_live_bullets gauge\n";
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        stream << "gravityarena_live_bullets{player=\"" << i << "\"} "
+               << live_bullets[i].load(std::memory_order_relaxed) << "\n";
+    }
+    stream << "# TYPE gravityarena_memory_bytes gauge\n";
+    for (int i = 0; i < MemoryTags::COUNT; i++) {
+        stream << "gravityarena_memory_bytes{tag=\"" << Allocations::tag_name(i) << "\"} "
+               << memory_current[i].load(std::memory_order_relaxed) << "\n";
+    }
+    stream << "# TYPE gravityarena_memory_peak_bytes gauge\n";
+    for (int i = 0; i < MemoryTags::COUNT; i++) {
+        stream << "gravityarena_memory_peak_bytes{tag=\"" << Allocations::tag_name(i) << "\"} "
+               << memory_peak[i].load(std::memory_order_relaxed) << "\n";
+    }
+    stream << "# TYPE gravityarena_memory_allocations_total counter\n";
+    for (int i = 0; i < MemoryTags::COUNT; i++) {
+        stream << "gravityarena_memory_allocations_total{tag=\"" << Allocations::tag_name(i) << "\"} "
+               << memory_allocations[i].load(std::memory_order_relaxed) << "\n";
+    }
+    for (int histogram = 0; histogram < MetricHistograms::COUNT; histogram++) {
+        std::string name = std::string("gravityarena_") + HISTOGRAM_NAMES[histogram];
+        stream << "# TYPE " << name << " histogram\n";
+        std::uint64_t cumulative = 0;
+        for (int i = 0; i <= BUCKET_COUNT; i++) {
+            cumulative += sum_bucket(histogram, i);
+            stream << name << "_bucket{le=\"";
+            write_bucket_bound(stream, i);
+            stream << "\"} " << cumulative << "\n";
+        }
+        stream << name << "_sum " << sum_seconds(histogram) << "\n"
+               << name << "_count " << cumulative << "\n";
+    }
+}
+
+void Metrics::write_json(std::ostream& stream) {
+    stream << "{";
+    for (int i = 0; i < MetricCounters::COUNT; i++) {
+        stream << "\"" << COUNTER_NAMES[i] << "\": " << get(i) << ", ";
+    }
+    for (int i = 0; i < MetricGauges::COUNT; i++) {
+        stream << "\"" << GAUGE_NAMES[i] << "\": " << gauges[i].load(std::memory_order_relaxed) << ", ";
+    }
+    stream << "\"live_bullets\": [";
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        stream << (i ? ", " : "") << live_bullets[i].load(std::memory_order_relaxed);
+    }
+    stream << "], \"memory\": {";
+    for (int i = 0; i < MemoryTags::COUNT; i++) {
+        stream << (i ? ", " : "") << "\"" << Allocations::tag_name(i) << "\": {\"current\": "
+               << memory_current[i].load(std::memory_order_relaxed) << ", \"peak\": "
+               << memory_peak[i].load(std::memory_order_relaxed) << ", \"allocations\": "
+               << memory_allocations[i].load(std::memory_order_relaxed) << "}";
+    }
+    stream << "}";
+    for (int histogram = 0; histogram < MetricHistograms::COUNT; histogram++) {
+        stream << ", \"" << HISTOGRAM_NAMES[histogram] << "\": {";
+        std::uint64_t count = 0;
+        for (int i = 0; i <= BUCKET_COUNT; i++) {
+            std::uint64_t bucket = sum_bucket(histogram, i);
+            count += bucket;
+            stream << "\"";
+            write_bucket_bound(stream, i);
+            stream << "\": " << bucket << ", ";
+        }
+        stream << "\"sum\": " << sum_seconds(histogram) << ", \"count\": " << count << "}";
+    }
+    stream << "}\n";
+}
+
+MetricsExporter::MetricsExporter(unsigned short port, std::string dump_path, sf::Time dump_interval) :
+        port(port),
+        dump_path(dump_path),
+        dump_interval(dump_interval),
+        running(false)
+{}
+
+MetricsExporter::~MetricsExporter() {
+    stop();
+}
+
+bool MetricsExporter::start() {
+    if (listener.listen(port, sf::IpAddress::LocalHost) != sf::Socket::Done) {
+        std::cerr << "metrics: cannot listen on port " << port << std::endl;
+        return false;
+    }
+    listener.setBlocking(false);
+    running = true;
+    worker = std::thread(&MetricsExporter::work, this);
+    return true;
+}
+
+// The final dump is written even if the listener never started.
+void MetricsExporter::stop() {
+    if (running) {
+        running = false;
+        worker.join();
+        listener.close();
+    }
+    if (!dump_path.empty()) {
+        dump();
+    }
+}
+
+void MetricsExporter::work() {
+    MemoryScope scope(MemoryTags::NETWORK);
+    sf::Clock sample_clock;
+    sf::Clock dump_clock;
+    sf::TcpSocket client;
+    while (running) {
+        if (listener.accept(client) == sf::Socket::Done) {
+            serve(client);
+        }
+        if (sample_clock.getElapsedTime() >= sf::seconds(1)) {
+            sample_clock.restart();
+            Metrics::sample();
+        }
+        if (!dump_path.empty() && dump_clock.getElapsedTime() >= dump_interval) {
+            dump_clock.restart();
+            dump();
+        }
+        sf::sleep(sf::milliseconds(20));
+    }
+}
+
+// The client socket stays non-blocking and gets a deadline, so a client that connects and never sends
+// or never reads cannot stall the worker, and stop() with it.
+void MetricsExporter::serve(sf::TcpSocket& client) {
+    client.setBlocking(false);
+    sf::Clock clock;
+    sf::Time timeout = sf::milliseconds(CLIENT_TIMEOUT_MS);
+    char request[1024];
+    std::size_t length = 0;
+    std::string line;
+    while (line.empty() && length < sizeof(request) && clock.getElapsedTime() < timeout) {
+        std::size_t received = 0;
+        sf::Socket::Status status = client.receive(request + length, sizeof(request) - length, received);
+        length += received;
+        if (status == sf::Socket::NotReady) {
+            sf::sleep(sf::milliseconds(1));
+        } else if (status != sf::Socket::Done) {
+            break;
+        }
+        std::string text(request, length);
+        if (text.find('\r') != std::string::npos) {
+            line = text.substr(0, text.find('\r'));
+        }
+    }
+    if (line.empty()) {
+        client.disconnect();
+        return;
+    }
+
+    std::ostringstream body;
+    std::string status = "200 OK";
+    std::string type;
+    if (line.compare(0, 18, "GET /metrics.json ") == 0) {
+        type = "application/json";
+        Metrics::write_json(body);
+    } else if (line.compare(0, 13, "GET /metrics ") == 0) {
+        type = "text/plain; version=0.0.4";
+        Metrics::write_prometheus(body);
+    } else {
+        status = "404 Not Found";
+        type = "text/plain";
+        body << "not found\n";
+    }
+
+    std::ostringstream response;
+    response << "HTTP/1.0 " << status << "\r\nContent-Type: " << type << "\r\nContent-Length: "
+             << body.str().size() << "\r\nConnection: close\r\n\r\n" << body.str();
+    std::string data = response.str();
+    std::size_t offset = 0;
+    while (offset < data.size() && clock.getElapsedTime() < timeout) {
+        std::size_t sent = 0;
+        sf::Socket::Status status = client.send(data.data() + offset, data.size() - offset, sent);
+        offset += sent;
+        if (status == sf::Socket::NotReady || status == sf::Socket::Partial) {
+            sf::sleep(sf::milliseconds(1));
+        } else if (status != sf::Socket::Done) {
+            break;
+        }
+    }
+    client.disconnect();
+}
+
+// Written to a temporary file first so readers never see a partial dump.
+void MetricsExporter::dump() {
+    std::string temporary_path = dump_path + ".tmp";
+    {
+        std::ofstream file(temporary_path);
+        Metrics::write_json(file);
+    }
+    std::rename(temporary_path.c_str(), dump_path.c_str());
+}
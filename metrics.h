@@ -0,0 +1,81 @@
+#ifndef GRAVITYARENA_METRICS_H
+#define GRAVITYARENA_METRICS_H
+
+#include <SFML/Network.hpp>
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+#include <thread>
+#include "allocations.h"
+
+namespace MetricCounters {
+    enum Enum {
+        TICKS,
+        FRAMES,
+        TRAIL_STEPS,
+        COLLISION_TESTS,
+        MASK_TESTS,
+        RELAY_BYTES,
+        RELAY_KEYFRAMES,
+        RELAY_RESYNCS,
+        COUNT
+    };
+}
+
+namespace MetricGauges {
+    enum Enum {
+        TICKS_PER_SECOND,
+        SIMULATION_ALLOCATIONS,
+        RESIDENT_MEMORY,
+        SPECTATORS,
+        COUNT
+    };
+}
+
+namespace MetricHistograms {
+    enum Enum {
+        FRAME_TIME,
+        INPUT_LATENCY,
+        COUNT
+    };
+}
+
+// Process-wide counters, gauges and latency histograms. Counters and histograms are sharded per thread,
+// so the hot-path updates are plain relaxed stores into memory only the calling thread writes.
+namespace Metrics {
+    const int MAX_PLAYERS = 8;
+
+    void add(int counter, std::uint64_t amount = 1);
+    void observe(int histogram, float seconds);
+    void set(int gauge, std::int64_t value);
+    void set_live_bullets(int player, int count);
+    void set_memory(int tag, const MemoryUsage& usage);
+
+    std::uint64_t get(int counter);
+    void sample();
+    void write_prometheus(std::ostream& stream);
+    void write_json(std::ostream& stream);
+}
+
+// Serves /metrics (Prometheus text format) and /metrics.json on localhost and periodically writes the
+// JSON to a file, all from a background thread.
+class MetricsExporter {
+public:
+    MetricsExporter(unsigned short port, std::string dump_path, sf::Time dump_interval);
+    ~MetricsExporter();
+    bool start();
+    void stop();
+private:
+    unsigned short port;
+    std::string dump_path;
+    sf::Time dump_interval;
+    sf::TcpListener listener;
+    std::thread worker;
+    std::atomic<bool> running;
+
+    void work();
+    void serve(sf::TcpSocket& client);
+    void dump();
+};
+
+#endif //GRAVITYARENA_METRICS_H
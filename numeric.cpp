@@ -0,0 +1,161 @@
+#include "numeric.h"
+#include "game.h"
+
+#ifdef GRAVITYARENA_FIXED_POINT
+
+namespace {
+    const int CORDIC_BITS = 30;
+    const int CORDIC_ITERATIONS = 30;
+    const std::int64_t CORDIC_ONE = std::int64_t(1) << CORDIC_BITS;
+    const std::int64_t CORDIC_GAIN = 652032874;
+    // atan(2^-i) in degrees, scaled by 2^CORDIC_BITS.
+    const std::int64_t CORDIC_ANGLES[CORDIC_ITERATIONS] = {
+            48318382080, 28524006506, 15071301663, 7650428050, 3840059795, 1921901881, 961185452, 480622056,
+            240314695, 120157806, 60078960, 30039487, 15019745, 7509872, 3754936, 1877468, 938734, 469367,
+            234684, 117342, 58671, 29335, 14668, 7334, 3667, 1833, 917, 458, 229, 115
+    };
+    const int SINE_TABLE_SIZE = 1024;
+
+    std::int64_t shift_right(std::int64_t value, int bits) {
+        return value >= 0 ? value >> bits : -((-value) >> bits);
+    }
+
+    std::int64_t cordic_sine(std::int64_t degrees) {
+        std::int64_t x = CORDIC_GAIN;
+        std::int64_t y = 0;
+        std::int64_t z = degrees;
+        for (int i = 0; i < CORDIC_ITERATIONS; i++) {
+            std::int64_t next_x;
+            if (z >= 0) {
+                next_x = x - shift_right(y, i);
+                y += shift_right(x, i);
+                z -= CORDIC_ANGLES[i];
+            } else {
+                next_x = x + shift_right(y, i);
+                y -= shift_right(x, i);
+                z += CORDIC_ANGLES[i];
+            }
+            x = next_x;
+        }
+        return y;
+    }
+
+    struct SineTable {
+        std::int64_t values[SINE_TABLE_SIZE + 1];
+
+        SineTable() {
+            for (int i = 0; i <= SINE_TABLE_SIZE; i++) {
+                values[i] = cordic_sine(90 * CORDIC_ONE * i / SINE_TABLE_SIZE);
+            }
+        }
+    };
+
+    const SineTable& sine_table() {
+        static const SineTable table;
+        return table;
+    }
+}
+
+Scalar scalar_abs(Scalar value) {
+    return value < 0 ? -value : value;
+}
+
+Scalar scalar_sqrt(Scalar value) {
+    if (value <= 0) {
+        return 0;
+    }
+    std::uint64_t remainder = (std::uint64_t) value.get_raw() << Fixed::FRACTION_BITS;
+    std::uint64_t root = 0;
+    std::uint64_t bit = std::uint64_t(1) << 62;
+    while (bit > remainder) {
+        bit >>= 2;
+    }
+    while (bit) {
+        if (remainder >= root + bit) {
+            remainder -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return Fixed::from_raw((std::int64_t) root);
+}
+
+Scalar scalar_sin(Scalar degrees) {
+    const std::int64_t quarter = 90 * Fixed::ONE;
+    std::int64_t angle = degrees.get_raw() % (4 * quarter);
+    if (angle < 0) {
+        angle += 4 * quarter;
+    }
+    int quadrant = (int) (angle / quarter);
+    angle %= quarter;
+    if (quadrant % 2) {
+        angle = quarter - angle;
+    }
+    std::int64_t position = angle * SINE_TABLE_SIZE;
+    std::int64_t index = position / quarter;
+    std::int64_t fraction = position % quarter;
+    const std::int64_t* values = sine_table().values;
+    std::int64_t value = values[index];
+    if (index < SINE_TABLE_SIZE) {
+        value += (values[index + 1] - values[index]) * fraction / quarter;
+    }
+    value = shift_right(value, CORDIC_BITS - Fixed::FRACTION_BITS);
+    return Fixed::from_raw(quadrant >= 2 ? -value : value);
+}
+
+Scalar scalar_cos(Scalar degrees) {
+    return scalar_sin(degrees + 90);
+}
+
+Scalar scalar_atan(Scalar y, Scalar x) {
+    std::int64_t vector_x = scalar_abs(x).get_raw();
+    std::int64_t vector_y = scalar_abs(y).get_raw();
+    if (!vector_x && !vector_y) {
+        return 0;
+    }
+    while (vector_x < CORDIC_ONE / 2 && vector_y < CORDIC_ONE / 2) {
+        vector_x <<= 1;
+        vector_y <<= 1;
+    }
+    std::int64_t z = 0;
+    for (int i = 0; i < CORDIC_ITERATIONS; i++) {
+        std::int64_t next_x;
+        if (vector_y > 0) {
+            next_x = vector_x + shift_right(vector_y, i);
+            vector_y -= shift_right(vector_x, i);
+            z += CORDIC_ANGLES[i];
+        } else {
+            next_x = vector_x - shift_right(vector_y, i);
+            vector_y += shift_right(vector_x, i);
+            z -= CORDIC_ANGLES[i];
+        }
+        vector_x = next_x;
+    }
+    return Fixed::from_raw(shift_right(z, CORDIC_BITS - Fixed::FRACTION_BITS));
+}
+
+#else
+
+Scalar scalar_abs(Scalar value) {
+    return std::abs(value);
+}
+
+Scalar scalar_sqrt(Scalar value) {
+    return std::sqrt(value);
+}
+
+Scalar scalar_sin(Scalar degrees) {
+    return std::sin(to_radians(degrees));
+}
+
+Scalar scalar_cos(Scalar degrees) {
+    return std::cos(to_radians(degrees));
+}
+
+Scalar scalar_atan(Scalar y, Scalar x) {
+    return to_degrees(std::atan(std::abs(y / x)));
+}
+
+#endif
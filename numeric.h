@@ -0,0 +1,108 @@
+#ifndef GRAVITYARENA_NUMERIC_H
+#define GRAVITYARENA_NUMERIC_H
+
+#include <SFML/Graphics.hpp>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+#ifdef GRAVITYARENA_FIXED_POINT
+
+// Signed 48.16 fixed point. Every operation is integer arithmetic with truncation toward zero,
+// so results are identical on any compiler, optimisation level and platform.
+class Fixed {
+public:
+    static const int FRACTION_BITS = 16;
+    static const std::int64_t ONE = std::int64_t(1) << FRACTION_BITS;
+
+    Fixed() : raw(0) {}
+
+    template <typename T, typename std::enable_if<std::is_integral<T>::value, int>::type = 0>
+    Fixed(T value) : raw((std::int64_t) value * ONE) {}
+
+    template <typename T, typename std::enable_if<std::is_floating_point<T>::value, int>::type = 0>
+    Fixed(T value) : raw((std::int64_t) (value * ONE)) {}
+
+    template <typename T, typename std::enable_if<std::is_integral<T>::value, int>::type = 0>
+    explicit operator T() const {
+        return (T) (raw / ONE);
+    }
+
+    template <typename T, typename std::enable_if<std::is_floating_point<T>::value, int>::type = 0>
+    explicit operator T() const {
+        return (T) raw / ONE;
+    }
+
+    static Fixed from_raw(std::int64_t raw) {
+        Fixed fixed;
+        fixed.raw = raw;
+        return fixed;
+    }
+
+    std::int64_t get_raw() const {
+        return raw;
+    }
+
+    Fixed operator -() const {
+        return from_raw(-raw);
+    }
+
+    Fixed& operator +=(Fixed other) {
+        raw += other.raw;
+        return *this;
+    }
+
+    Fixed& operator -=(Fixed other) {
+        raw -= other.raw;
+        return *this;
+    }
+
+    Fixed& operator *=(Fixed other) {
+        raw = raw * other.raw / ONE;
+        return *this;
+    }
+
+    // Dividing by zero saturates instead of trapping, as the float build gives infinity.
+    Fixed& operator /=(Fixed other) {
+        if (other.raw == 0) {
+            std::int64_t limit = std::numeric_limits<std::int64_t>::max();
+            raw = raw > 0 ? limit : raw < 0 ? -limit : 0;
+            return *this;
+        }
+        raw = raw * ONE / other.raw;
+        return *this;
+    }
+
+    friend Fixed operator +(Fixed left, Fixed right) { return left += right; }
+    friend Fixed operator -(Fixed left, Fixed right) { return left -= right; }
+    friend Fixed operator *(Fixed left, Fixed right) { return left *= right; }
+    friend Fixed operator /(Fixed left, Fixed right) { return left /= right; }
+    friend bool operator ==(Fixed left, Fixed right) { return left.raw == right.raw; }
+    friend bool operator !=(Fixed left, Fixed right) { return left.raw != right.raw; }
+    friend bool operator <(Fixed left, Fixed right) { return left.raw < right.raw; }
+    friend bool operator <=(Fixed left, Fixed right) { return left.raw <= right.raw; }
+    friend bool operator >(Fixed left, Fixed right) { return left.raw > right.raw; }
+    friend bool operator >=(Fixed left, Fixed right) { return left.raw >= right.raw; }
+private:
+    std::int64_t raw;
+};
+
+typedef Fixed Scalar;
+
+#else
+
+typedef float Scalar;
+
+#endif
+
+typedef sf::Vector2<Scalar> Vector;
+
+Scalar scalar_abs(Scalar value);
+Scalar scalar_sqrt(Scalar value);
+Scalar scalar_sin(Scalar degrees);
+Scalar scalar_cos(Scalar degrees);
+// Degrees of atan(|y / x|), i.e. the angle folded into the first quadrant.
+Scalar scalar_atan(Scalar y, Scalar x);
+
+#endif //GRAVITYARENA_NUMERIC_H
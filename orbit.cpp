@@ -0,0 +1,26 @@
+#include "orbit.h"
+
+Orbit::Orbit(Vector center) :
+        center(center)
+{}
+
+Orbit Orbit::around(Scalar radius_x, Scalar radius_y, int period, Scalar phase) const {
+    Orbit orbit = *this;
+    orbit.terms.push_back({radius_x, radius_y, period, phase});
+    return orbit;
+}
+
+// Angles are taken from the tick modulo the period so they stay small and exact in fixed point.
+Vector Orbit::position(int tick) const {
+    Vector position = center;
+    for (const OrbitTerm& term : terms) {
+        Scalar angle = term.phase + Scalar(360 * (tick % term.period)) / Scalar(term.period);
+        position.x += scalar_cos(angle) * term.radius_x;
+        position.y += scalar_sin(angle) * term.radius_y;
+    }
+    return position;
+}
+
+bool Orbit::is_static() const {
+    return terms.empty();
+}
@@ -0,0 +1,27 @@
+#ifndef GRAVITYARENA_ORBIT_H
+#define GRAVITYARENA_ORBIT_H
+
+#include <vector>
+#include "numeric.h"
+
+struct OrbitTerm {
+    Scalar radius_x;
+    Scalar radius_y;
+    int period;
+    Scalar phase;
+};
+
+// A closed-form path: a center plus any number of elliptic terms, each turning at a fixed rate.
+// A moon's orbit is its planet's orbit with one more term, so any tick is found without integrating.
+class Orbit {
+public:
+    Orbit(Vector center = Vector());
+    Orbit around(Scalar radius_x, Scalar radius_y, int period, Scalar phase = Scalar()) const;
+    Vector position(int tick) const;
+    bool is_static() const;
+private:
+    Vector center;
+    std::vector<OrbitTerm> terms;
+};
+
+#endif //GRAVITYARENA_ORBIT_H
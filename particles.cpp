@@ -0,0 +1,135 @@
+#include <cmath>
+#include "particles.h"
+#include "game.h"
+#include "gravity.h"
+
+ParticleSystem::ParticleSystem(int capacity, float size) :
+        capacity(capacity),
+        half_size(size / 2),
+        x(capacity),
+        y(capacity),
+        velocity_x(capacity),
+        velocity_y(capacity),
+        life(capacity),
+        lifetime(capacity),
+        colors(capacity),
+        vertices(capacity * 4)
+{}
+
+void ParticleSystem::emit_thrust(sf::Vector2f coordinates, float rotation, sf::Vector2f velocity) {
+    emit(coordinates, velocity, rotation + 180, 25, 2, 5, 4, FPS / 2, sf::Color(255, 190, 80));
+}
+
+void ParticleSystem::emit_explosion(sf::Vector2f coordinates, sf::Vector2f velocity) {
+    emit(coordinates, velocity, 0, 360, 1, 8, 400, FPS * 2, sf::Color(255, 120, 40));
+    emit(coordinates, velocity, 0, 360, 0.5f, 3, 200, FPS * 3, sf::Color(90, 90, 90));
+}
+
+void ParticleSystem::emit_impact(sf::Vector2f coordinates, sf::Vector2f velocity) {
+    float direction = to_degrees(std::atan2(velocity.y, velocity.x)) + 180;
+    emit(coordinates, sf::Vector2f(), direction, 120, 1, 4, 24, FPS / 2, sf::Color(255, 240, 200));
+}
+
+// Particles past capacity are dropped rather than replacing live ones.
+void ParticleSystem::emit(sf::Vector2f coordinates, sf::Vector2f velocity, float direction, float spread,
+                          float min_speed, float max_speed, int emitted, int particle_lifetime, sf::Color color) {
+    std::uniform_real_distribution<float> angle(to_radians(direction - spread / 2), to_radians(direction + spread / 2));
+    std::uniform_real_distribution<float> speed(min_speed, max_speed);
+    std::uniform_real_distribution<float> jitter(0.5f, 1);
+    int end = std::min(capacity, count + emitted);
+    for (int i = count; i < end; i++) {
+        float particle_angle = angle(random);
+        float particle_speed = speed(random);
+        x[i] = coordinates.x;
+        y[i] = coordinates.y;
+        velocity_x[i] = velocity.x + std::cos(particle_angle) * particle_speed;
+        velocity_y[i] = velocity.y + std::sin(particle_angle) * particle_speed;
+        lifetime[i] = particle_lifetime * jitter(random);
+        life[i] = lifetime[i];
+        colors[i] = color;
+    }
+    count = end;
+}
+
+void ParticleSystem::clear_attractors() {
+    attractors.clear();
+}
+
+void ParticleSystem::add_attractor(sf::Vector2f coordinates, float radius, float mass) {
+    attractors.push_back({coordinates, radius, mass});
+}
+
+// Each loop runs over plain float arrays without branches so the compiler can vectorize it.
+void ParticleSystem::update() {
+    float* px = x.data();
+    float* py = y.data();
+    float* pvx = velocity_x.data();
+    float* pvy = velocity_y.data();
+    float* plife = life.data();
+    for (const Attractor& attractor : attractors) {
+        float ax = attractor.coordinates.x;
+        float ay = attractor.coordinates.y;
+        float radius_squared = attractor.radius * attractor.radius;
+        apply_gravity(ax, ay, attractor.mass * GRAVITY * PARTICLE_MASS, px, py, pvx, pvy, count);
+        for (int i = 0; i < count; i++) {
+            float dx = ax - px[i];
+            float dy = ay - py[i];
+            plife[i] = dx * dx + dy * dy < radius_squared ? 0 : plife[i];
+        }
+    }
+    for (int i = 0; i < count; i++) {
+        px[i] += pvx[i];
+        py[i] += pvy[i];
+        plife[i] -= 1;
+    }
+    for (int i = 0; i < count;) {
+        if (plife[i] <= 0) {
+            remove(i);
+        } else {
+            i++;
+        }
+    }
+}
+
+void ParticleSystem::display(sf::RenderTarget& target, sf::FloatRect visible_area) {
+    float left = visible_area.left - half_size;
+    float top = visible_area.top - half_size;
+    float right = visible_area.left + visible_area.width + half_size;
+    float bottom = visible_area.top + visible_area.height + half_size;
+    int visible = 0;
+    for (int i = 0; i < count; i++) {
+        if (x[i] < left || x[i] > right || y[i] < top || y[i] > bottom) {
+            continue;
+        }
+        sf::Color color = colors[i];
+        color.a = (sf::Uint8) (color.a * (life[i] / lifetime[i]));
+        sf::Vertex* quad = &vertices[visible * 4];
+        quad[0] = sf::Vertex(sf::Vector2f(x[i] - half_size, y[i] - half_size), color);
+        quad[1] = sf::Vertex(sf::Vector2f(x[i] + half_size, y[i] - half_size), color);
+        quad[2] = sf::Vertex(sf::Vector2f(x[i] + half_size, y[i] + half_size), color);
+        quad[3] = sf::Vertex(sf::Vector2f(x[i] - half_size, y[i] + half_size), color);
+        visible += 1;
+    }
+    if (visible > 0) {
+        target.draw(vertices.data(), (size_t) visible * 4, sf::Quads);
+    }
+}
+
+int ParticleSystem::size() const {
+    return count;
+}
+
+int ParticleSystem::get_capacity() const {
+    return capacity;
+}
+
+void ParticleSystem::remove(int index) {
+    count -= 1;
+    x[index] = x[count];
+    y[index] = y[count];
+    velocity_x[index] = velocity_x[count];
+    velocity_y[index] = velocity_y[count];
+    life[index] = life[count];
+    lifetime[index] = lifetime[count];
+    colors[index] = colors[count];
+}
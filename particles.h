@@ -0,0 +1,47 @@
+#ifndef GRAVITYARENA_PARTICLES_H
+#define GRAVITYARENA_PARTICLES_H
+
+#include <SFML/Graphics.hpp>
+#include <random>
+
+// Cosmetic particles kept outside the simulated state, stored as a fixed-capacity structure of arrays.
+class ParticleSystem {
+public:
+    ParticleSystem(int capacity, float size);
+    void emit_thrust(sf::Vector2f coordinates, float rotation, sf::Vector2f velocity);
+    void emit_explosion(sf::Vector2f coordinates, sf::Vector2f velocity);
+    void emit_impact(sf::Vector2f coordinates, sf::Vector2f velocity);
+    void emit(sf::Vector2f coordinates, sf::Vector2f velocity, float direction, float spread,
+              float min_speed, float max_speed, int count, int lifetime, sf::Color color);
+
+    void clear_attractors();
+    void add_attractor(sf::Vector2f coordinates, float radius, float mass);
+    void update();
+    void display(sf::RenderTarget& target, sf::FloatRect visible_area);
+    int size() const;
+    int get_capacity() const;
+private:
+    struct Attractor {
+        sf::Vector2f coordinates;
+        float radius;
+        float mass;
+    };
+
+    int capacity;
+    int count = 0;
+    float half_size;
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> velocity_x;
+    std::vector<float> velocity_y;
+    std::vector<float> life;
+    std::vector<float> lifetime;
+    std::vector<sf::Color> colors;
+    std::vector<Attractor> attractors;
+    std::vector<sf::Vertex> vertices;
+    std::minstd_rand random;
+
+    void remove(int index);
+};
+
+#endif //GRAVITYARENA_PARTICLES_H
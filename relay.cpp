@@ -0,0 +1,257 @@
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include "relay.h"
+#include "allocations.h"
+#include "metrics.h"
+
+namespace {
+    const std::size_t HEADER_SIZE = 11;
+
+    void write_bytes(std::vector<char>& data, std::uint32_t value, int count) {
+        for (int i = 0; i < count; i++) {
+            data.push_back((char) (value >> (8 * i)));
+        }
+    }
+
+    void write_float(std::vector<char>& data, float value) {
+        std::uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        write_bytes(data, bits, 4);
+    }
+
+    void write_vector(std::vector<char>& data, Vector value) {
+        write_float(data, (float) value.x);
+        write_float(data, (float) value.y);
+    }
+
+    int changed_groups(const PlayerSnapshot& player, const PlayerSnapshot& previous) {
+        int groups = 0;
+        if (player.coordinates != previous.coordinates || player.velocity != previous.velocity
+            || player.rotation != previous.rotation || player.sprite_type != previous.sprite_type
+            || player.sprite_index != previous.sprite_index || player.accelerating != previous.accelerating
+            || player.moving != previous.moving || player.active != previous.active) {
+            groups |= RelayGroups::MOTION;
+        }
+        if (player.health != previous.health) {
+            groups |= RelayGroups::HEALTH;
+        }
+        if (player.trail != previous.trail) {
+            groups |= RelayGroups::TRAIL;
+        }
+        if (!player.bullets.empty() || !previous.bullets.empty()) {
+            groups |= RelayGroups::BULLETS;
+        }
+        if (!player.impacts.empty()) {
+            groups |= RelayGroups::IMPACTS;
+        }
+        return groups;
+    }
+
+    void write_player(std::vector<char>& data, const PlayerSnapshot& player, int groups) {
+        write_bytes(data, (std::uint32_t) groups, 1);
+        if (groups & RelayGroups::MOTION) {
+            write_vector(data, player.coordinates);
+            write_vector(data, player.velocity);
+            write_float(data, (float) player.rotation);
+            write_bytes(data, (std::uint32_t) player.sprite_type, 1);
+            write_bytes(data, (std::uint32_t) player.sprite_index, 1);
+            write_bytes(data, (std::uint32_t) (player.accelerating | player.moving << 1 | player.active << 2), 1);
+        }
+        if (groups & RelayGroups::HEALTH) {
+            write_bytes(data, (std::uint32_t) player.health, 2);
+        }
+        if (groups & RelayGroups::TRAIL) {
+            write_bytes(data, (std::uint32_t) player.trail.size(), 2);
+            for (Vector point : player.trail) {
+                write_vector(data, point);
+            }
+        }
+        if (groups & RelayGroups::BULLETS) {
+            write_bytes(data, (std::uint32_t) player.bullets.size(), 2);
+            for (const Bullet& bullet : player.bullets) {
+                write_vector(data, bullet.get_coordinates());
+                write_float(data, (float) bullet.get_rotation());
+            }
+        }
+        if (groups & RelayGroups::IMPACTS) {
+            write_bytes(data, (std::uint32_t) player.impacts.size(), 1);
+            for (const Impact& impact : player.impacts) {
+                write_vector(data, impact.coordinates);
+                write_vector(data, impact.velocity);
+            }
+        }
+    }
+
+    std::int64_t thread_cpu_microseconds() {
+#ifdef __linux__
+        timespec time;
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+        return (std::int64_t) time.tv_sec * 1000000 + time.tv_nsec / 1000;
+#else
+        return 0;
+#endif
+    }
+}
+
+SpectatorRelay::SpectatorRelay(unsigned short port, int max_queued_frames) :
+        port(port),
+        max_queued_frames(max_queued_frames),
+        running(false),
+        cpu_microseconds(0)
+{}
+
+SpectatorRelay::~SpectatorRelay() {
+    stop();
+}
+
+bool SpectatorRelay::start() {
+    if (listener.listen(port) != sf::Socket::Done) {
+        std::cerr << "relay: cannot listen on port " << port << std::endl;
+        return false;
+    }
+    listener.setBlocking(false);
+    running = true;
+    worker = std::thread(&SpectatorRelay::work, this);
+    return true;
+}
+
+void SpectatorRelay::stop() {
+    if (!running) {
+        return;
+    }
+    running = false;
+    worker.join();
+    listener.close();
+    spectators.clear();
+}
+
+// Called from the simulation thread; only copies, the encoding happens on the relay thread.
+void SpectatorRelay::publish(const WorldSnapshot& snapshot) {
+    MemoryScope scope(MemoryTags::NETWORK);
+    snapshots.get_write_buffer() = snapshot;
+    snapshots.publish();
+}
+
+sf::Time SpectatorRelay::get_cpu_time() const {
+    return sf::microseconds(cpu_microseconds.load(std::memory_order_relaxed));
+}
+
+void SpectatorRelay::work() {
+    MemoryScope scope(MemoryTags::NETWORK);
+    while (running) {
+        accept();
+        bool idle = true;
+        if (snapshots.update()) {
+            broadcast(snapshots.get_read_buffer());
+            idle = false;
+        }
+        // Sockets that cannot take more data do not keep the thread awake.
+        for (auto it = spectators.begin(); it != spectators.end();) {
+            long sent = flush(*it);
+            if (sent < 0) {
+                it = spectators.erase(it);
+                continue;
+            }
+            idle = idle && sent == 0;
+            ++it;
+        }
+        Metrics::set(MetricGauges::SPECTATORS, (std::int64_t) spectators.size());
+        cpu_microseconds.store(thread_cpu_microseconds(), std::memory_order_relaxed);
+        if (idle) {
+            sf::sleep(sf::milliseconds(1));
+        }
+    }
+}
+
+void SpectatorRelay::accept() {
+    std::unique_ptr<sf::TcpSocket> socket(new sf::TcpSocket);
+    while (listener.accept(*socket) == sf::Socket::Done) {
+        socket->setBlocking(false);
+        Spectator spectator;
+        spectator.socket = std::move(socket);
+        spectators.push_back(std::move(spectator));
+        socket.reset(new sf::TcpSocket);
+    }
+}
+
+// Spectators that are too far behind lose their queued deltas, keeping only a partly sent frame so
+// the stream stays aligned, and are brought back with a keyframe encoded once for all of them.
+void SpectatorRelay::broadcast(const WorldSnapshot& snapshot) {
+    bool need_delta = false;
+    bool need_keyframe = false;
+    for (Spectator& spectator : spectators) {
+        if (spectator.synced && (int) spectator.queue.size() >= max_queued_frames) {
+            spectator.queue.resize(spectator.offset ? 1 : 0);
+            spectator.synced = false;
+            Metrics::add(MetricCounters::RELAY_RESYNCS);
+        }
+        need_delta = need_delta || spectator.synced;
+        need_keyframe = need_keyframe || !spectator.synced;
+    }
+
+    RelayFrame delta = need_delta ? encode(snapshot, false) : nullptr;
+    RelayFrame keyframe = need_keyframe ? encode(snapshot, true) : nullptr;
+    for (Spectator& spectator : spectators) {
+        spectator.queue.push_back(spectator.synced ? delta : keyframe);
+        spectator.synced = true;
+    }
+    previous = snapshot;
+    has_previous = true;
+}
+
+RelayFrame SpectatorRelay::encode(const WorldSnapshot& snapshot, bool keyframe) const {
+    keyframe = keyframe || !has_previous || previous.players.size() != snapshot.players.size();
+    std::shared_ptr<std::vector<char>> frame = std::make_shared<std::vector<char>>();
+    std::vector<char>& data = *frame;
+    data.push_back('G');
+    data.push_back('A');
+    write_bytes(data, keyframe ? RelayFrameTypes::KEYFRAME : RelayFrameTypes::DELTA, 1);
+    write_bytes(data, (std::uint32_t) snapshot.tick, 4);
+    write_bytes(data, 0, 4);
+
+    bool planets = keyframe || snapshot.planets != previous.planets;
+    write_bytes(data, planets ? (std::uint32_t) snapshot.planets.size() : 0, 1);
+    if (planets) {
+        for (Vector planet : snapshot.planets) {
+            write_vector(data, planet);
+        }
+    }
+    write_bytes(data, (std::uint32_t) snapshot.players.size(), 1);
+    for (int i = 0; i < snapshot.players.size(); i++) {
+        int groups = keyframe ? RelayGroups::ALL : changed_groups(snapshot.players[i], previous.players[i]);
+        write_player(data, snapshot.players[i], groups);
+    }
+
+    std::uint32_t size = (std::uint32_t) (data.size() - HEADER_SIZE);
+    for (int i = 0; i < 4; i++) {
+        data[HEADER_SIZE - 4 + i] = (char) (size >> (8 * i));
+    }
+    if (keyframe) {
+        Metrics::add(MetricCounters::RELAY_KEYFRAMES);
+    }
+    return frame;
+}
+
+// Returns the bytes sent, or -1 once the spectator has gone.
+long SpectatorRelay::flush(Spectator& spectator) {
+    long total = 0;
+    while (!spectator.queue.empty()) {
+        const std::vector<char>& data = *spectator.queue.front();
+        std::size_t sent = 0;
+        sf::Socket::Status status = spectator.socket->send(data.data() + spectator.offset,
+                                                           data.size() - spectator.offset, sent);
+        spectator.offset += sent;
+        total += (long) sent;
+        Metrics::add(MetricCounters::RELAY_BYTES, sent);
+        if (status == sf::Socket::Done) {
+            spectator.queue.pop_front();
+            spectator.offset = 0;
+        } else if (status == sf::Socket::Partial || status == sf::Socket::NotReady) {
+            return total;
+        } else {
+            return -1;
+        }
+    }
+    return total;
+}
@@ -0,0 +1,72 @@
+#ifndef GRAVITYARENA_RELAY_H
+#define GRAVITYARENA_RELAY_H
+
+#include <SFML/Network.hpp>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "snapshot.h"
+#include "triplebuffer.h"
+
+namespace RelayFrameTypes {
+    enum Enum {
+        KEYFRAME,
+        DELTA
+    };
+}
+
+namespace RelayGroups {
+    enum Enum {
+        MOTION = 1,
+        HEALTH = 2,
+        TRAIL = 4,
+        BULLETS = 8,
+        IMPACTS = 16,
+        ALL = 31
+    };
+}
+
+typedef std::shared_ptr<const std::vector<char>> RelayFrame;
+
+// Streams the match to spectators from a background thread. Each snapshot is encoded once into a
+// shared frame and every spectator sends from that same buffer. A frame starts with "GA", its type,
+// the tick and the payload size, little endian. The payload holds a planet flag byte (and positions),
+// then per player a byte of changed groups followed by those groups. A keyframe sends every group.
+// A spectator that falls max_queued_frames behind drops its queue and resumes from the next keyframe.
+class SpectatorRelay {
+public:
+    SpectatorRelay(unsigned short port, int max_queued_frames);
+    ~SpectatorRelay();
+    bool start();
+    void stop();
+    void publish(const WorldSnapshot& snapshot);
+    sf::Time get_cpu_time() const;
+private:
+    struct Spectator {
+        std::unique_ptr<sf::TcpSocket> socket;
+        std::deque<RelayFrame> queue;
+        std::size_t offset = 0;
+        bool synced = false;
+    };
+
+    unsigned short port;
+    int max_queued_frames;
+    sf::TcpListener listener;
+    std::thread worker;
+    std::atomic<bool> running;
+    std::atomic<std::int64_t> cpu_microseconds;
+    TripleBuffer<WorldSnapshot> snapshots;
+    WorldSnapshot previous;
+    bool has_previous = false;
+    std::vector<Spectator> spectators;
+
+    void work();
+    void accept();
+    void broadcast(const WorldSnapshot& snapshot);
+    RelayFrame encode(const WorldSnapshot& snapshot, bool keyframe) const;
+    long flush(Spectator& spectator);
+};
+
+#endif //GRAVITYARENA_RELAY_H
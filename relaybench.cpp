@@ -0,0 +1,195 @@
+#include <SFML/Network.hpp>
+#include <cstdlib>
+#include <iomanip>
+#include <memory>
+#include <random>
+#include <sstream>
+#include "game.h"
+#include "level.h"
+#include "metrics.h"
+#include "relay.h"
+#include "simulation.h"
+
+// Runs a match on the simulation thread with the relay attached, connects fake spectators over
+// localhost and reports the relay thread's CPU time per spectator for each spectator count.
+// Stalled spectators connect but stop reading, to exercise the keyframe fallback.
+
+namespace {
+    const std::size_t HEADER_SIZE = 11;
+
+    struct FakeSpectator {
+        sf::TcpSocket socket;
+        std::vector<char> pending;
+        int frames = 0;
+        int keyframes = 0;
+        int last_tick = -1;
+        bool valid = true;
+        bool stalled = false;
+
+        void read() {
+            char buffer[65536];
+            std::size_t received = 0;
+            while (socket.receive(buffer, sizeof(buffer), received) == sf::Socket::Done) {
+                pending.insert(pending.end(), buffer, buffer + received);
+            }
+            std::size_t position = 0;
+            while (pending.size() - position >= HEADER_SIZE) {
+                const unsigned char* header = (const unsigned char*) pending.data() + position;
+                std::uint32_t tick = header[3] | header[4] << 8 | header[5] << 16 | (std::uint32_t) header[6] << 24;
+                std::uint32_t size = header[7] | header[8] << 8 | header[9] << 16 | (std::uint32_t) header[10] << 24;
+                if (pending.size() - position < HEADER_SIZE + size) {
+                    break;
+                }
+                valid = valid && header[0] == 'G' && header[1] == 'A' && (int) tick > last_tick
+                        && (frames > 0 || header[2] == RelayFrameTypes::KEYFRAME);
+                keyframes += header[2] == RelayFrameTypes::KEYFRAME;
+                frames += 1;
+                last_tick = (int) tick;
+                position += HEADER_SIZE + size;
+            }
+            pending.erase(pending.begin(), pending.begin() + position);
+        }
+    };
+
+    struct Result {
+        int spectators;
+        double seconds;
+        int ticks;
+        double cpu_seconds;
+        double bytes;
+        int frames;
+        int keyframes;
+        int resyncs;
+        bool valid;
+    };
+
+    Result run(int spectator_count, int stalled_count, float seconds, int level, unsigned short port) {
+        World world = create_world(level, headless_sprites());
+        SpectatorRelay relay(port, RELAY_MAX_QUEUED_FRAMES);
+        Simulation simulation(std::move(world), sf::seconds(1.f / FPS));
+        relay.start();
+        simulation.attach_relay(relay);
+
+        std::vector<std::unique_ptr<FakeSpectator>> spectators;
+        for (int i = 0; i < spectator_count; i++) {
+            std::unique_ptr<FakeSpectator> spectator(new FakeSpectator);
+            if (spectator->socket.connect(sf::IpAddress::LocalHost, port) != sf::Socket::Done) {
+                std::cerr << "cannot connect spectator " << i << std::endl;
+                break;
+            }
+            spectator->socket.setBlocking(false);
+            spectator->stalled = i < stalled_count;
+            spectators.push_back(std::move(spectator));
+        }
+
+        std::uint64_t bytes_before = Metrics::get(MetricCounters::RELAY_BYTES);
+        std::uint64_t keyframes_before = Metrics::get(MetricCounters::RELAY_KEYFRAMES);
+        std::uint64_t resyncs_before = Metrics::get(MetricCounters::RELAY_RESYNCS);
+        sf::Time cpu_before = relay.get_cpu_time();
+        int first_tick = simulation.get_snapshot().tick;
+
+        // Both ships hold their guns down and steer at random so frames carry bullets and trails.
+        std::mt19937 random(1);
+        std::vector<int> keys = {sf::Keyboard::W, sf::Keyboard::D, sf::Keyboard::A,
+                                 sf::Keyboard::Up, sf::Keyboard::Right, sf::Keyboard::Left};
+        std::vector<bool> pressed(keys.size());
+        simulation.send_key(sf::Keyboard::Q, true);
+        simulation.send_key(sf::Keyboard::Slash, true);
+        simulation.start();
+
+        sf::Clock clock;
+        while (clock.getElapsedTime().asSeconds() < seconds) {
+            if (random() % 1000 < 30) {
+                int key = random() % keys.size();
+                pressed[key] = !pressed[key];
+                simulation.send_key(keys[key], pressed[key]);
+            }
+            for (std::unique_ptr<FakeSpectator>& spectator : spectators) {
+                if (!spectator->stalled) {
+                    spectator->read();
+                }
+            }
+            simulation.receive();
+            sf::sleep(sf::milliseconds(1));
+        }
+        simulation.stop();
+        simulation.receive();
+        Result result;
+        result.spectators = (int) spectators.size();
+        result.seconds = clock.getElapsedTime().asSeconds();
+        result.ticks = simulation.get_snapshot().tick - first_tick;
+        result.cpu_seconds = (relay.get_cpu_time() - cpu_before).asSeconds();
+        relay.stop();
+
+        result.bytes = (double) (Metrics::get(MetricCounters::RELAY_BYTES) - bytes_before);
+        result.keyframes = (int) (Metrics::get(MetricCounters::RELAY_KEYFRAMES) - keyframes_before);
+        result.resyncs = (int) (Metrics::get(MetricCounters::RELAY_RESYNCS) - resyncs_before);
+        result.frames = 0;
+        result.valid = true;
+        for (std::unique_ptr<FakeSpectator>& spectator : spectators) {
+            if (!spectator->stalled) {
+                spectator->read();
+                result.frames += spectator->frames;
+                result.valid = result.valid && spectator->valid;
+            }
+        }
+        return result;
+    }
+
+    std::vector<int> parse_list(std::string text) {
+        std::vector<int> values;
+        std::istringstream stream(text);
+        std::string value;
+        while (std::getline(stream, value, ',')) {
+            values.push_back(std::atoi(value.c_str()));
+        }
+        return values;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    std::vector<int> spectator_counts = {1, 10, 100, 300};
+    int stalled = 0;
+    float seconds = 5;
+    int level = 1;
+    unsigned short port = RELAY_PORT;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string option = argv[i];
+        if (option == "--spectators") {
+            spectator_counts = parse_list(argv[i + 1]);
+        } else if (option == "--stalled") {
+            stalled = std::atoi(argv[i + 1]);
+        } else if (option == "--seconds") {
+            seconds = (float) std::atof(argv[i + 1]);
+        } else if (option == "--level") {
+            level = std::atoi(argv[i + 1]);
+        } else if (option == "--port") {
+            port = (unsigned short) std::atoi(argv[i + 1]);
+        } else {
+            std::cerr << "unknown option " << option << std::endl;
+            return 2;
+        }
+    }
+    if (level < 0 || level >= LEVEL_COUNT) {
+        std::cerr << "unknown level " << level << ", levels are 0 to " << LEVEL_COUNT - 1 << std::endl;
+        return 2;
+    }
+
+    bool valid = true;
+    std::cout << std::fixed << std::setprecision(2);
+    for (int count : spectator_counts) {
+        Result result = run(count, std::min(stalled, count), seconds, level, port);
+        int ticks = std::max(result.ticks, 1);
+        std::cout << "spectators=" << std::setw(4) << std::left << result.spectators << std::right
+                  << " relay cpu " << std::setw(6) << 100 * result.cpu_seconds / result.seconds << " %"
+                  << " us/tick " << std::setw(8) << 1e6 * result.cpu_seconds / ticks
+                  << " us/tick/spectator " << std::setw(6) << 1e6 * result.cpu_seconds / ticks / std::max(result.spectators, 1)
+                  << " kB/s " << std::setw(9) << result.bytes / result.seconds / 1000
+                  << " frames " << result.frames
+                  << " keyframes " << result.keyframes
+                  << " resyncs " << result.resyncs
+                  << (result.valid ? "" : " INVALID STREAM") << std::endl;
+        valid = valid && result.valid;
+    }
+    return valid ? 0 : 1;
+}
@@ -0,0 +1,51 @@
+#include "renderscaler.h"
+#include "game.h"
+
+RenderScaler::RenderScaler(sf::Vector2u dimensions, float min_scale, float max_scale, sf::Time target_frame_time) :
+        dimensions(dimensions),
+        min_scale(min_scale),
+        max_scale(max_scale),
+        scale(max_scale),
+        target_frame_time(target_frame_time.asSeconds()),
+        average_frame_time(target_frame_time.asSeconds())
+{}
+
+bool RenderScaler::create() {
+    // The texture is allocated once at the ceiling; lower scales only render into its top-left corner.
+    available = texture.create((unsigned) (dimensions.x * max_scale), (unsigned) (dimensions.y * max_scale));
+    if (available) {
+        texture.setSmooth(false);
+        sprite.setTexture(texture.getTexture());
+    }
+    return available;
+}
+
+bool RenderScaler::is_available() const {
+    return available;
+}
+
+sf::RenderTarget& RenderScaler::begin(sf::View view) {
+    view.setViewport(sf::FloatRect(0, 0, scale / max_scale, scale / max_scale));
+    texture.setView(view);
+    return texture;
+}
+
+void RenderScaler::display(sf::RenderTarget& target) {
+    texture.display();
+    sprite.setTextureRect(sf::IntRect(0, 0, (int) (dimensions.x * scale), (int) (dimensions.y * scale)));
+    sprite.setScale(1 / scale, 1 / scale);
+    target.draw(sprite);
+}
+
+void RenderScaler::update(sf::Time frame_time) {
+    average_frame_time += (frame_time.asSeconds() - average_frame_time) * RENDER_SCALE_SMOOTHING;
+    if (average_frame_time > target_frame_time) {
+        scale = std::max(min_scale, scale - RENDER_SCALE_STEP);
+    } else if (average_frame_time < target_frame_time * RENDER_SCALE_HEADROOM) {
+        scale = std::min(max_scale, scale + RENDER_SCALE_STEP);
+    }
+}
+
+float RenderScaler::get_scale() const {
+    return scale;
+}
@@ -0,0 +1,27 @@
+#ifndef GRAVITYARENA_RENDERSCALER_H
+#define GRAVITYARENA_RENDERSCALER_H
+
+#include <SFML/Graphics.hpp>
+
+class RenderScaler {
+public:
+    RenderScaler(sf::Vector2u dimensions, float min_scale, float max_scale, sf::Time target_frame_time);
+    bool create();
+    bool is_available() const;
+    sf::RenderTarget& begin(sf::View view);
+    void display(sf::RenderTarget& target);
+    void update(sf::Time frame_time);
+    float get_scale() const;
+private:
+    sf::RenderTexture texture;
+    sf::Sprite sprite;
+    sf::Vector2u dimensions;
+    float min_scale;
+    float max_scale;
+    float scale;
+    float target_frame_time;
+    float average_frame_time;
+    bool available = false;
+};
+
+#endif //GRAVITYARENA_RENDERSCALER_H
@@ -0,0 +1,112 @@
+#include <utility>
+#include "simulation.h"
+#include "allocations.h"
+#include "game.h"
+#include "metrics.h"
+#include "relay.h"
+
+Simulation::Simulation(World world, sf::Time tick_time) :
+        world(std::move(world)),
+        tick_time(tick_time),
+        inputs(INPUT_QUEUE_SIZE),
+        running(false)
+{
+    publish();
+    receive();
+}
+
+Simulation::~Simulation() {
+    stop();
+}
+
+void Simulation::start() {
+    running = true;
+    worker = std::thread(&Simulation::work, this);
+}
+
+void Simulation::stop() {
+    if (!running) {
+        return;
+    }
+    running = false;
+    worker.join();
+}
+
+// Returns false when the key had to be held back because the simulation is behind on input.
+bool Simulation::send_key(int key, bool pressed, int sequence) {
+    flush_inputs();
+    if (held_inputs.empty() && inputs.push({key, pressed, sequence})) {
+        return true;
+    }
+    held_inputs.push_back({key, pressed, sequence});
+    return false;
+}
+
+void Simulation::flush_inputs() {
+    std::size_t sent = 0;
+    while (sent < held_inputs.size() && inputs.push(held_inputs[sent])) {
+        sent++;
+    }
+    held_inputs.erase(held_inputs.begin(), held_inputs.begin() + sent);
+}
+
+// Must be attached before start().
+void Simulation::attach_relay(SpectatorRelay& relay_p) {
+    relay = &relay_p;
+}
+
+bool Simulation::receive() {
+    flush_inputs();
+    return snapshots.update();
+}
+
+const WorldSnapshot& Simulation::get_snapshot() const {
+    return snapshots.get_read_buffer();
+}
+
+void Simulation::work() {
+    sf::Clock clock;
+    sf::Time next_tick = clock.getElapsedTime();
+    while (running) {
+        step();
+
+        // After a long stall the simulation resumes at normal speed instead of racing to catch up.
+        next_tick += tick_time;
+        sf::Time now = clock.getElapsedTime();
+        if (next_tick > now) {
+            sf::sleep(next_tick - now);
+        } else if (now - next_tick > tick_time * 4.f) {
+            next_tick = now;
+        }
+    }
+}
+
+void Simulation::step() {
+    InputEvent event;
+    while (inputs.pop(event)) {
+        world.handle_key(event.key, event.pressed);
+        input_sequence = event.sequence;
+    }
+
+    Allocations::begin_watch("tick");
+    world.tick();
+    Allocations::end_watch();
+    publish();
+
+    const std::vector<Player>& players = world.get_players();
+    Metrics::add(MetricCounters::TICKS);
+    Metrics::set(MetricGauges::SIMULATION_ALLOCATIONS, (std::int64_t) Allocations::count());
+    for (int i = 0; i < players.size(); i++) {
+        Metrics::set_live_bullets(i, players[i].bullet_count());
+    }
+}
+
+void Simulation::publish() {
+    WorldSnapshot& snapshot = snapshots.get_write_buffer();
+    world.capture(snapshot);
+    snapshot.input_sequence = input_sequence;
+    if (relay) {
+        relay->publish(snapshot);
+    }
+    snapshots.publish();
+}
@@ -0,0 +1,50 @@
+#ifndef GRAVITYARENA_SIMULATION_H
+#define GRAVITYARENA_SIMULATION_H
+
+#include <SFML/System.hpp>
+#include <atomic>
+#include <thread>
+#include "world.h"
+#include "spscqueue.h"
+#include "triplebuffer.h"
+
+class SpectatorRelay;
+
+struct InputEvent {
+    int key;
+    bool pressed;
+    int sequence;
+};
+
+// Runs the world at a fixed tick rate on its own thread. Input arrives through a lock-free queue and
+// each tick is published as a snapshot, so the render thread never touches the world itself. Without
+// start(), the caller drives the world one step() at a time instead. Keys that find the queue full are
+// held back in order and retried on the next send_key() or receive(), so a release is never lost.
+class Simulation {
+public:
+    Simulation(World world, sf::Time tick_time);
+    ~Simulation();
+    void start();
+    void stop();
+    void step();
+    bool send_key(int key, bool pressed, int sequence = 0);
+    void attach_relay(SpectatorRelay& relay);
+    bool receive();
+    const WorldSnapshot& get_snapshot() const;
+private:
+    World world;
+    sf::Time tick_time;
+    SpscQueue<InputEvent> inputs;
+    std::vector<InputEvent> held_inputs;
+    TripleBuffer<WorldSnapshot> snapshots;
+    std::thread worker;
+    std::atomic<bool> running;
+    int input_sequence = 0;
+    SpectatorRelay* relay = nullptr;
+
+    void work();
+    void publish();
+    void flush_inputs();
+};
+
+#endif //GRAVITYARENA_SIMULATION_H
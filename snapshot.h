@@ -0,0 +1,31 @@
+#ifndef GRAVITYARENA_SNAPSHOT_H
+#define GRAVITYARENA_SNAPSHOT_H
+
+#include "classes.h"
+
+// Everything the renderer needs from one simulated tick. Snapshots are reused, so refilling one
+// only allocates when a container outgrows its previous size.
+struct PlayerSnapshot {
+    Vector coordinates;
+    Vector velocity;
+    Scalar rotation;
+    int sprite_type;
+    int sprite_index;
+    int health;
+    int shots;
+    bool accelerating;
+    bool moving;
+    bool active;
+    std::vector<Vector> trail;
+    std::vector<Bullet> bullets;
+    std::vector<Impact> impacts;
+};
+
+struct WorldSnapshot {
+    int tick = 0;
+    int input_sequence = 0;
+    std::vector<PlayerSnapshot> players;
+    std::vector<Vector> planets;
+};
+
+#endif //GRAVITYARENA_SNAPSHOT_H
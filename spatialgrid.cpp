@@ -0,0 +1,50 @@
+#include <cmath>
+#include "spatialgrid.h"
+
+SpatialGrid::SpatialGrid(sf::Vector2u dimensions, unsigned cell_size) :
+        cell_size(cell_size),
+        cell_count((dimensions.x + cell_size - 1) / cell_size, (dimensions.y + cell_size - 1) / cell_size),
+        cells(cell_count.x * cell_count.y)
+{}
+
+void SpatialGrid::clear() {
+    for (std::vector<int>& cell : cells) {
+        cell.clear();
+    }
+}
+
+void SpatialGrid::insert(int index, sf::FloatRect bounds) {
+    sf::IntRect range = cell_range(bounds);
+    for (int y = range.top; y < range.top + range.height; y++) {
+        for (int x = range.left; x < range.left + range.width; x++) {
+            cells[y * cell_count.x + x].push_back(index);
+        }
+    }
+    if (index >= (int) stamps.size()) {
+        stamps.resize(index + 1, 0);
+    }
+}
+
+void SpatialGrid::query(sf::FloatRect area, std::vector<int>& result) const {
+    // Stamping each visited index keeps items spanning several cells from being reported twice.
+    stamp += 1;
+    sf::IntRect range = cell_range(area);
+    for (int y = range.top; y < range.top + range.height; y++) {
+        for (int x = range.left; x < range.left + range.width; x++) {
+            for (int index : cells[y * cell_count.x + x]) {
+                if (stamps[index] != stamp) {
+                    stamps[index] = stamp;
+                    result.push_back(index);
+                }
+            }
+        }
+    }
+}
+
+sf::IntRect SpatialGrid::cell_range(sf::FloatRect area) const {
+    int left = std::max(0, (int) std::floor(area.left / cell_size));
+    int top = std::max(0, (int) std::floor(area.top / cell_size));
+    int right = std::min((int) cell_count.x, (int) std::floor((area.left + area.width) / cell_size) + 1);
+    int bottom = std::min((int) cell_count.y, (int) std::floor((area.top + area.height) / cell_size) + 1);
+    return sf::IntRect(left, top, std::max(0, right - left), std::max(0, bottom - top));
+}
@@ -0,0 +1,22 @@
+#ifndef GRAVITYARENA_SPATIALGRID_H
+#define GRAVITYARENA_SPATIALGRID_H
+
+#include <SFML/Graphics.hpp>
+
+class SpatialGrid {
+public:
+    SpatialGrid(sf::Vector2u dimensions, unsigned cell_size);
+    void clear();
+    void insert(int index, sf::FloatRect bounds);
+    void query(sf::FloatRect area, std::vector<int>& result) const;
+private:
+    unsigned cell_size;
+    sf::Vector2u cell_count;
+    std::vector<std::vector<int>> cells;
+    mutable std::vector<unsigned> stamps;
+    mutable unsigned stamp = 0;
+
+    sf::IntRect cell_range(sf::FloatRect area) const;
+};
+
+#endif //GRAVITYARENA_SPATIALGRID_H
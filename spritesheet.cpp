@@ -1,4 +1,5 @@
 #include "spritesheet.h"
+#include "allocations.h"
 
 void SpriteSheet::scale_sprite(sf::Sprite *sprite, int scale) {
     if ((!scale && default_scale) || scale) {
@@ -10,7 +11,21 @@ void SpriteSheet::scale_sprite(sf::Sprite *sprite, int scale) {
 }
 
 SpriteSheet::SpriteSheet(std::string name, int scale) {
-    sheet.loadFromFile(name);
+    MemoryScope memory_scope(MemoryTags::ASSETS);
+    image.loadFromFile(name);
+    sheet.loadFromImage(image);
+    if (scale <= 1) {
+        default_scale = 0;
+    }
+    else {
+        default_scale = scale;
+    }
+}
+
+SpriteSheet::SpriteSheet(AssetManager& assets, std::string name, int scale) {
+    MemoryScope memory_scope(MemoryTags::ASSETS);
+    assets.upload(name, sheet);
+    image = assets.get_image(name);
     if (scale <= 1) {
         default_scale = 0;
     }
@@ -88,3 +103,12 @@ SpriteVector SpriteSheet::get_custom_sprites(sf::Vector2u dimensions, int number
     }
     return sprites;
 }
+
+CollisionMask SpriteSheet::get_mask(const sf::Sprite& sprite, sf::Uint8 threshold) const {
+    return CollisionMask::from_alpha(image, sprite.getTextureRect(), threshold);
+}
+
+// The texture lives with the graphics driver, so the allocator never sees it.
+std::size_t SpriteSheet::get_texture_bytes() const {
+    return (std::size_t) sheet.getSize().x * sheet.getSize().y * 4;
+}
@@ -2,12 +2,15 @@
 #define GRAVITYARENA_SPRITESHEET_H
 
 #include <SFML/Graphics.hpp>
+#include "assets.h"
+#include "collisionmask.h"
 
 typedef std::vector<sf::Sprite> SpriteVector;
 
 class SpriteSheet {
 private:
     sf::Texture sheet;
+    sf::Image image;
     int default_scale;
     int farthest_y = 0;
 
@@ -15,11 +18,14 @@ private:
 
 public:
     SpriteSheet(std::string p_name, int p_scale);
+    SpriteSheet(AssetManager& assets, std::string name, int scale);
     sf::Sprite get_sprite(sf::Vector2u dimensions, int x=0, int scale=0);
     SpriteVector get_sprites(sf::Vector2u dimensions, int x=0, int scale=0, bool update=true);
     SpriteVector get_sprites(std::vector<sf::Vector2u> dimensions, int x=0, int scale=0, bool update=true);
     SpriteVector get_custom_sprites(std::vector<sf::Vector2u> dimensions, int constant, int index, int x=0, int scale=0, bool update=true);
     SpriteVector get_custom_sprites(sf::Vector2u dimensions, int number, int x=0, int scale=0, bool update=true);
+    CollisionMask get_mask(const sf::Sprite& sprite, sf::Uint8 threshold=0) const;
+    std::size_t get_texture_bytes() const;
 };
 
 #endif //GRAVITYARENA_SPRITESHEET_H
@@ -0,0 +1,44 @@
+#ifndef GRAVITYARENA_SPSCQUEUE_H
+#define GRAVITYARENA_SPSCQUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+// Bounded lock-free queue for exactly one producer thread and one consumer thread.
+template <typename T>
+class SpscQueue {
+public:
+    SpscQueue(std::size_t capacity) :
+            slots(capacity + 1),
+            head(0),
+            tail(0)
+    {}
+
+    bool push(const T& value) {
+        std::size_t current = tail.load(std::memory_order_relaxed);
+        std::size_t next = (current + 1) % slots.size();
+        if (next == head.load(std::memory_order_acquire)) {
+            return false;
+        }
+        slots[current] = value;
+        tail.store(next, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T& value) {
+        std::size_t current = head.load(std::memory_order_relaxed);
+        if (current == tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+        value = slots[current];
+        head.store((current + 1) % slots.size(), std::memory_order_release);
+        return true;
+    }
+private:
+    std::vector<T> slots;
+    std::atomic<std::size_t> head;
+    std::atomic<std::size_t> tail;
+};
+
+#endif //GRAVITYARENA_SPSCQUEUE_H
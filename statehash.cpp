@@ -0,0 +1,54 @@
+#include <cstring>
+#include "statehash.h"
+
+StateHash::StateHash(std::uint64_t seed, std::vector<StateField>* fields) :
+        hash(seed),
+        fields(fields)
+{}
+
+void StateHash::begin_field(const char* name, int index) {
+    if (fields) {
+        fields->push_back({name, index, 0});
+    }
+}
+
+void StateHash::add(std::uint64_t value) {
+    hash = mix(hash, value);
+    if (fields && !fields->empty()) {
+        fields->back().hash = mix(fields->back().hash, value);
+    }
+}
+
+void StateHash::add(int value) {
+    add((std::uint64_t) (std::uint32_t) value);
+}
+
+void StateHash::add(bool value) {
+    add((std::uint64_t) value);
+}
+
+void StateHash::add(float value) {
+    std::uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    add((std::uint64_t) bits);
+}
+
+#ifdef GRAVITYARENA_FIXED_POINT
+void StateHash::add(Fixed value) {
+    add((std::uint64_t) value.get_raw());
+}
+#endif
+
+void StateHash::add(const Vector& value) {
+    add(value.x);
+    add(value.y);
+}
+
+std::uint64_t StateHash::get() const {
+    return hash;
+}
+
+std::uint64_t StateHash::mix(std::uint64_t hash, std::uint64_t value) {
+    hash = (hash ^ value) * 0xff51afd7ed558ccdULL;
+    return hash ^ (hash >> 32);
+}
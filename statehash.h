@@ -0,0 +1,34 @@
+#ifndef GRAVITYARENA_STATEHASH_H
+#define GRAVITYARENA_STATEHASH_H
+
+#include <cstdint>
+#include <vector>
+#include "numeric.h"
+
+struct StateField {
+    const char* name;
+    int index;
+    std::uint64_t hash;
+};
+
+class StateHash {
+public:
+    StateHash(std::uint64_t seed = 0, std::vector<StateField>* fields = nullptr);
+    void begin_field(const char* name, int index);
+    void add(std::uint64_t value);
+    void add(int value);
+    void add(bool value);
+    void add(float value);
+#ifdef GRAVITYARENA_FIXED_POINT
+    void add(Fixed value);
+#endif
+    void add(const Vector& value);
+    std::uint64_t get() const;
+private:
+    std::uint64_t hash;
+    std::vector<StateField>* fields;
+
+    static std::uint64_t mix(std::uint64_t hash, std::uint64_t value);
+};
+
+#endif //GRAVITYARENA_STATEHASH_H
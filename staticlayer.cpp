@@ -0,0 +1,39 @@
+#include "staticlayer.h"
+
+bool StaticLayer::create(sf::Vector2u dimensions) {
+    valid = false;
+    available = dimensions.x <= sf::Texture::getMaximumSize()
+                && dimensions.y <= sf::Texture::getMaximumSize()
+                && texture.create(dimensions.x, dimensions.y);
+    if (available) {
+        sprite.setTexture(texture.getTexture(), true);
+    }
+    return available;
+}
+
+void StaticLayer::invalidate() {
+    valid = false;
+}
+
+bool StaticLayer::is_available() const {
+    return available;
+}
+
+bool StaticLayer::is_valid() const {
+    return available && valid;
+}
+
+sf::RenderTarget& StaticLayer::begin(sf::Color color) {
+    texture.setView(texture.getDefaultView());
+    texture.clear(color);
+    return texture;
+}
+
+void StaticLayer::end() {
+    texture.display();
+    valid = true;
+}
+
+void StaticLayer::display(sf::RenderTarget& target) const {
+    target.draw(sprite);
+}
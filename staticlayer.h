@@ -0,0 +1,22 @@
+#ifndef GRAVITYARENA_STATICLAYER_H
+#define GRAVITYARENA_STATICLAYER_H
+
+#include <SFML/Graphics.hpp>
+
+class StaticLayer {
+public:
+    bool create(sf::Vector2u dimensions);
+    void invalidate();
+    bool is_available() const;
+    bool is_valid() const;
+    sf::RenderTarget& begin(sf::Color color);
+    void end();
+    void display(sf::RenderTarget& target) const;
+private:
+    sf::RenderTexture texture;
+    sf::Sprite sprite;
+    bool available = false;
+    bool valid = false;
+};
+
+#endif //GRAVITYARENA_STATICLAYER_H
@@ -0,0 +1,45 @@
+#ifndef GRAVITYARENA_TRIPLEBUFFER_H
+#define GRAVITYARENA_TRIPLEBUFFER_H
+
+#include <atomic>
+
+// Hands the latest value from one writer thread to one reader thread without locks. The writer fills
+// get_write_buffer() and publishes it; the reader swaps in the newest published value with update().
+// Neither side ever waits, and the reader may skip values when the writer is faster.
+template <typename T>
+class TripleBuffer {
+public:
+    TripleBuffer() :
+            shared(1)
+    {}
+
+    T& get_write_buffer() {
+        return buffers[write_index];
+    }
+
+    void publish() {
+        write_index = shared.exchange(write_index | FRESH, std::memory_order_acq_rel) & INDEX_MASK;
+    }
+
+    bool update() {
+        if (!(shared.load(std::memory_order_relaxed) & FRESH)) {
+            return false;
+        }
+        read_index = shared.exchange(read_index, std::memory_order_acq_rel) & INDEX_MASK;
+        return true;
+    }
+
+    const T& get_read_buffer() const {
+        return buffers[read_index];
+    }
+private:
+    static const int INDEX_MASK = 3;
+    static const int FRESH = 4;
+
+    T buffers[3];
+    int write_index = 0;
+    int read_index = 2;
+    std::atomic<int> shared;
+};
+
+#endif //GRAVITYARENA_TRIPLEBUFFER_H
@@ -0,0 +1,175 @@
+#include "world.h"
+#include "allocations.h"
+#include "game.h"
+
+World::World(std::vector<Player> players, std::vector<Planet> planets, sf::FloatRect bounds) :
+        players(players),
+        planets(planets),
+        bounds(bounds),
+        arena(FRAME_ARENA_SIZE)
+{
+    for (Player& player : this->players) {
+        player.reserve_storage();
+    }
+}
+
+void World::handle_key(int key, bool pressed) {
+    for (int i = 0; i < players.size(); i++) {
+        if (players[i].is_alive() && players[i].in_controls(key)) {
+            handle_action(i, players[i].action_type(key), pressed);
+        }
+    }
+}
+
+void World::handle_action(int player, int action, bool pressed) {
+    switch (action) {
+        case PlayerActions::ACCELERATE:
+            players[player].accelerate(pressed);
+            break;
+        case PlayerActions::ROTATE_RIGHT:
+            players[player].turn(pressed, 1);
+            break;
+        case PlayerActions::ROTATE_LEFT:
+            players[player].turn(pressed, -1);
+            break;
+        case PlayerActions::SHOOT:
+            players[player].shoot(pressed);
+            break;
+    }
+}
+
+void World::tick() {
+    MemoryScope scope(MemoryTags::PHYSICS);
+    update_players();
+    arena.reset();
+
+    tick_count += 1;
+    StateHash hash(state_hash);
+    hash_state(hash);
+    state_hash = hash.get();
+}
+
+void World::update_players() {
+    for (Planet& planet : planets) {
+        planet.update_orbit(tick_count);
+    }
+    if (bullet_gravity) {
+        apply_bullet_gravity();
+    }
+    ArenaVector<MassThing> masses(planets.begin(), planets.end(), ArenaAllocator<MassThing>(arena));
+    for (Player& player : players) {
+        player.clear_impacts();
+    }
+    for (auto it_player = players.begin(); it_player != players.end(); ++it_player) {
+        if (it_player->is_active()) {
+            if (it_player->is_alive()) {
+                it_player->accelerate();
+                it_player->turn();
+                it_player->shoot();
+                it_player->update_gravity(masses);
+                it_player->update_coordinates();
+
+                Metrics::add(MetricCounters::COLLISION_TESTS, planets.size());
+                for (Planet& planet : planets) {
+                    if (it_player->hits(planet)) {
+                        it_player->planet_collision();
+                    }
+                }
+
+                it_player->update_bullets(bounds);
+                it_player->bullet_collision(players, planets);
+                it_player->update_trail(planets, masses, tick_count + 1);
+            } else {
+                if (it_player->is_moving()) {
+                    it_player->update_gravity(masses);
+                    it_player->update_coordinates();
+                }
+                if (it_player->update_sprites(false)) {
+                    it_player->end();
+                }
+            }
+        }
+    }
+}
+
+void World::set_bullet_gravity(bool enabled) {
+    bullet_gravity = enabled;
+}
+
+// Every live bullet is pulled by the planets and moved in one batch; the players then only age and cull
+// them, and move the bullets they shoot this tick.
+void World::apply_bullet_gravity() {
+    bullet_batch.clear();
+    for (const Player& player : players) {
+        if (player.is_active() && player.is_alive()) {
+            player.gather_bullets(bullet_batch);
+        }
+    }
+    if (bullet_batch.size() == 0) {
+        return;
+    }
+    for (const Planet& planet : planets) {
+        Vector coordinates = planet.get_coordinates();
+        bullet_batch.apply(coordinates.x, coordinates.y, Scalar(planet.get_mass() * BULLET_MASS * GRAVITY));
+    }
+    bullet_batch.integrate();
+    int offset = 0;
+    for (Player& player : players) {
+        if (player.is_active() && player.is_alive()) {
+            offset = player.scatter_bullets(bullet_batch, offset);
+        }
+    }
+}
+
+std::vector<Player>& World::get_players() {
+    return players;
+}
+
+std::vector<Planet>& World::get_planets() {
+    return planets;
+}
+
+const std::vector<Player>& World::get_players() const {
+    return players;
+}
+
+const std::vector<Planet>& World::get_planets() const {
+    return planets;
+}
+
+int World::get_tick() const {
+    return tick_count;
+}
+
+std::uint64_t World::get_hash() const {
+    return state_hash;
+}
+
+const FrameArena& World::get_arena() const {
+    return arena;
+}
+
+void World::capture(WorldSnapshot& snapshot) const {
+    snapshot.tick = tick_count;
+    snapshot.players.resize(players.size());
+    for (int i = 0; i < players.size(); i++) {
+        players[i].capture(snapshot.players[i]);
+    }
+    snapshot.planets.resize(planets.size());
+    for (int i = 0; i < planets.size(); i++) {
+        snapshot.planets[i] = planets[i].get_coordinates();
+    }
+}
+
+void World::hash_fields(std::vector<StateField>& fields) const {
+    StateHash hash(0, &fields);
+    hash_state(hash);
+}
+
+void World::hash_state(StateHash& hash) const {
+    hash.begin_field("tick", -1);
+    hash.add(tick_count);
+    for (int i = 0; i < players.size(); i++) {
+        players[i].hash(hash, i);
+    }
+}
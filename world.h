@@ -0,0 +1,41 @@
+#ifndef GRAVITYARENA_WORLD_H
+#define GRAVITYARENA_WORLD_H
+
+#include <SFML/Graphics.hpp>
+#include "classes.h"
+#include "statehash.h"
+#include "snapshot.h"
+
+class World {
+public:
+    World(std::vector<Player> players, std::vector<Planet> planets, sf::FloatRect bounds);
+    void handle_key(int key, bool pressed);
+    void handle_action(int player, int action, bool pressed);
+    void tick();
+    void set_bullet_gravity(bool enabled);
+
+    std::vector<Player>& get_players();
+    std::vector<Planet>& get_planets();
+    const std::vector<Player>& get_players() const;
+    const std::vector<Planet>& get_planets() const;
+    int get_tick() const;
+    std::uint64_t get_hash() const;
+    void hash_fields(std::vector<StateField>& fields) const;
+    const FrameArena& get_arena() const;
+    void capture(WorldSnapshot& snapshot) const;
+private:
+    std::vector<Player> players;
+    std::vector<Planet> planets;
+    sf::FloatRect bounds;
+    int tick_count = 0;
+    std::uint64_t state_hash = 0;
+    bool bullet_gravity = false;
+    GravityBatch<Scalar> bullet_batch;
+    FrameArena arena;
+
+    void update_players();
+    void apply_bullet_gravity();
+    void hash_state(StateHash& hash) const;
+};
+
+#endif //GRAVITYARENA_WORLD_H